@@ -0,0 +1,85 @@
+#pragma once
+
+// Minimal benchmark harness: calibrates a batch size so each sample runs for
+// a measurable time, takes several samples and reports robust statistics as
+// one JSON object per line.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+using Clock = std::chrono::steady_clock;
+
+// Keep the optimizer from discarding a value or hoisting work out of a loop
+template <typename T>
+inline void doNotOptimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void clobberMemory() {
+    asm volatile("" : : : "memory");
+}
+
+struct Result {
+    std::string name;
+    long long param;      // catalog size or other scale knob, -1 if none
+    long long batch;      // operations per sample
+    int samples;
+    double medianNs;      // per operation
+    double minNs;
+    double madNs;         // median absolute deviation
+};
+
+inline void print(const Result& r) {
+    printf("{\"name\":\"%s\",\"param\":%lld,\"batch\":%lld,\"samples\":%d,"
+           "\"median_ns\":%.3f,\"min_ns\":%.3f,\"mad_ns\":%.3f}\n",
+           r.name.c_str(), r.param, r.batch, r.samples, r.medianNs, r.minNs, r.madNs);
+    fflush(stdout);
+}
+
+inline double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+// body(batch) runs `batch` operations. The batch grows until one sample takes
+// at least targetSeconds, capped at maxBatch for expensive operations.
+template <typename F>
+Result run(const std::string& name, long long param, F&& body,
+           int samples = 21, double targetSeconds = 0.002, long long maxBatch = 1LL << 24) {
+    long long batch = 1;
+    while (true) {
+        auto t0 = Clock::now();
+        body(batch);
+        double elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+        if (elapsed >= targetSeconds || batch >= maxBatch) break;
+        batch = std::min(maxBatch, batch * (elapsed > 0 ? std::max(2LL, (long long)(targetSeconds / elapsed)) : 10));
+    }
+
+    std::vector<double> perOp;
+    perOp.reserve(samples);
+    for (int i = 0; i < samples; i++) {
+        auto t0 = Clock::now();
+        body(batch);
+        double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        perOp.push_back(elapsed / batch);
+    }
+
+    double med = median(perOp);
+    std::vector<double> dev;
+    dev.reserve(perOp.size());
+    for (double x : perOp) dev.push_back(std::fabs(x - med));
+
+    Result r = {name, param, batch, samples, med,
+                *std::min_element(perOp.begin(), perOp.end()), median(dev)};
+    print(r);
+    return r;
+}
+
+} // namespace Bench
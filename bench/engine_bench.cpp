@@ -0,0 +1,198 @@
+// Engine hot paths: number formatting, BigNum against double arithmetic,
+// cost-curve powers, whole-table cost passes, LPS, the
+// per-tick update, clicks, persistence and catalog parsing, across several
+// catalog sizes.
+
+#include "bench.hpp"
+#include "../src/game.hpp"
+#include "../src/utils.hpp"
+#include "../src/power_table.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+// Synthetic catalog shaped like data/buildings.json: costs grow ~12x and
+// rates ~6x per tier
+std::string writeCatalog(const std::string& dir, int size) {
+    std::string path = dir + "/buildings_" + std::to_string(size) + ".json";
+    std::ofstream f(path);
+    f << "[\n";
+    for (int i = 0; i < size; i++) {
+        double cost = 15.0 * std::pow(12.0, std::fmod(i, 120.0));
+        double lps = 0.1 * std::pow(6.0, std::fmod(i, 120.0));
+        f << "  { \"id\": " << i << ", \"name\": \"Tier " << i << "\", \"basecost\": " << cost
+          << ", \"baselps\": " << lps << " }" << (i + 1 < size ? ",\n" : "\n");
+    }
+    f << "]\n";
+    return path;
+}
+
+void seedCounts(Game& game) {
+    for (int i = 0; i < game.buildings.size(); i++) {
+        game.buildings.setCount(i, (i * 7) % 50);
+    }
+    game.lines = 1e12;
+    game.updateLPS();
+}
+
+void benchFormatting() {
+    const BigNum values[] = {0.5, 999.99, 1234.5, 5.6e8, 7.7e15, 3.3e30, 1e40, BigNum::pow(10, 400)};
+    for (BigNum v : values) {
+        Bench::run("formatNumber", (long long)(v.log10() + 1e-9), [v](long long n) {
+            for (long long i = 0; i < n; i++) {
+                BigNum x = v;
+                Bench::doNotOptimize(x);
+                char buf[32];
+                Utils::formatNumber(x, buf, sizeof(buf));
+                Bench::doNotOptimize(buf);
+            }
+        });
+    }
+}
+
+// The per-tick DATA update and a price check, on double and on BigNum
+template <typename T> void benchArithmetic(const char* name) {
+    Bench::run(name, 0, [](long long n) {
+        T lines = 1e12, price = 3.7e13;
+        double gain = 123.25;
+        Bench::doNotOptimize(gain);
+        long long affordable = 0;
+        for (long long i = 0; i < n; i++) {
+            lines += gain * (1.0 / 60.0);
+            affordable += price * 1.15 <= lines;
+            Bench::doNotOptimize(lines);
+        }
+        Bench::doNotOptimize(affordable);
+    });
+}
+
+// A cost-curve power by purchase count: BigNum::pow against the table
+// BuildingTable and Game look it up in
+void benchPowers() {
+    for (int count : {10, 100, 1000, 10000}) {
+        Bench::run("BigNum::pow", count, [count](long long n) {
+            for (long long i = 0; i < n; i++) {
+                BigNum p = BigNum::pow(COST_SCALE_FACTOR, count + (int)(i & 7));
+                Bench::doNotOptimize(p);
+            }
+        });
+        PowerTable table(COST_SCALE_FACTOR);
+        Bench::run("PowerTable", count, [count, &table](long long n) {
+            for (long long i = 0; i < n; i++) {
+                BigNum p = table(count + (int)(i & 7));
+                Bench::doNotOptimize(p);
+            }
+        });
+    }
+}
+
+void benchCatalog(const std::string& dir, int size) {
+    std::string path = writeCatalog(dir, size);
+    Game game(0, 1.0, 0, dir);
+    game.loadBuildings(path);
+    seedCounts(game);
+
+    // Whole-table passes the shop and redraw scheduling make every frame
+    std::vector<BigNum> costs(game.buildings.size());
+    Bench::run("BuildingTable::costsOf", size, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            game.buildings.costsOf(10, game.lines, 0, game.buildings.size(), costs.data());
+            Bench::clobberMemory();
+        }
+    });
+
+    // Funds alternate across a price, so every call misses the memo and
+    // scans the table
+    const BigNum funds[2] = {game.lines, game.lines * 1e6};
+    Bench::run("BuildingTable::cheapestAbove", size, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            BigNum cost = game.buildings.cheapestAbove(10, funds[i & 1]);
+            Bench::doNotOptimize(cost);
+        }
+    });
+
+    // What a steady frame pays: funds still inside the memoized interval
+    Bench::run("BuildingTable::cheapestAbove memo", size, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            BigNum cost = game.buildings.cheapestAbove(10, game.lines);
+            Bench::doNotOptimize(cost);
+        }
+    });
+
+    // Rewrites the counts seedCounts set, so later passes see the same table
+    Bench::run("BuildingTable::setCount", size, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            int row = (int)(i % size);
+            game.buildings.setCount(row, (row * 7) % 50);
+            Bench::clobberMemory();
+        }
+    });
+
+    Bench::run("Game::updateLPS", size, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            game.updateLPS();
+            Bench::clobberMemory();
+        }
+    });
+
+    Bench::run("Game::tick", size, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            game.runCycle(1.0 / 60.0);
+            game.updateTimers(1.0 / 60.0);
+            Bench::clobberMemory();
+        }
+    });
+
+    Bench::run("Game::registerClick", size, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            game.registerClick();
+            Bench::clobberMemory();
+        }
+    });
+
+    Bench::run("Game::save+load", size, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            game.saveGame();
+            game.loadGame();
+        }
+    }, 11, 0.002, 64);
+
+    Bench::run("Game::loadBuildings", size, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            game.loadBuildings(path);
+        }
+    }, 11, 0.002, 4096);
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes = {13, 100, 1000, 10000};
+    if (argc > 1) {
+        sizes.clear();
+        for (int i = 1; i < argc; i++) sizes.push_back(std::atoi(argv[i]));
+    }
+
+    // Saves and generated catalogs live in a scratch dir, never the real save
+    char tmpl[] = "/tmp/cybergrind-bench-XXXXXX";
+    if (!mkdtemp(tmpl)) {
+        fprintf(stderr, "bench: cannot create a scratch directory\n");
+        return 1;
+    }
+
+    benchFormatting();
+    benchArithmetic<double>("double add+compare");
+    benchArithmetic<BigNum>("BigNum add+compare");
+    benchPowers();
+    for (int size : sizes) {
+        benchCatalog(tmpl, size);
+    }
+    // Each size's Game, and with it its save writer, is gone by now
+    std::error_code ec;
+    std::filesystem::remove_all(tmpl, ec);
+    return 0;
+}
@@ -0,0 +1,190 @@
+// Renderer::render against an offscreen ncurses screen (newterm on a pipe):
+// CPU time per frame and the exact bytes written to the terminal, for idle,
+// click-storm and resize scenarios at several terminal sizes. Also counts heap
+// allocations per frame; a steady-state (idle or click-storm) frame that
+// allocates at all makes the benchmark exit non-zero.
+
+#include "bench.hpp"
+#include "../src/game.hpp"
+#include "../src/renderer.hpp"
+#include <cstdio>
+#include <clocale>
+#include <cstdlib>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Interpose the C allocator so ncurses, stdio and operator new (which sits on
+// malloc) are all counted, not just C++ allocations
+static thread_local long long allocationCount = 0;
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+
+void* malloc(size_t size) {
+    allocationCount++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    allocationCount++;
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, size_t size) {
+    allocationCount++;
+    return __libc_realloc(p, size);
+}
+}
+
+namespace {
+
+struct Size {
+    int cols;
+    int rows;
+};
+
+double threadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// A screen whose output goes into a pipe we drain and count after each frame
+class OffscreenTerminal {
+public:
+    explicit OffscreenTerminal(Size size) {
+        int fds[2];
+        if (pipe(fds) != 0) return;
+        readFd = fds[0];
+        fcntl(readFd, F_SETFL, O_NONBLOCK);
+        // Big enough that a full repaint never blocks the writer
+        fcntl(fds[1], F_SETPIPE_SZ, 1 << 20);
+        out = fdopen(fds[1], "w");
+        in = fopen("/dev/null", "r");
+
+        setenv("LINES", std::to_string(size.rows).c_str(), 1);
+        setenv("COLUMNS", std::to_string(size.cols).c_str(), 1);
+        screen = newterm("xterm-256color", out, in);
+    }
+
+    ~OffscreenTerminal() {
+        if (screen) delscreen(screen);
+        if (out) fclose(out);
+        if (in) fclose(in);
+        if (readFd >= 0) close(readFd);
+    }
+
+    SCREEN* get() const { return screen; }
+
+    long long drain() {
+        char buf[65536];
+        long long total = 0;
+        ssize_t n;
+        while ((n = read(readFd, buf, sizeof(buf))) > 0) total += n;
+        return total;
+    }
+
+private:
+    SCREEN* screen = nullptr;
+    FILE* out = nullptr;
+    FILE* in = nullptr;
+    int readFd = -1;
+};
+
+enum class Scenario { IDLE, CLICK_STORM, RESIZE };
+
+// Returns the number of allocations made by the measured frames
+long long runScenario(const char* name, Scenario scenario, Size size, int frames, const std::string& dataHome) {
+    OffscreenTerminal term(size);
+    if (!term.get()) {
+        fprintf(stderr, "render_bench: newterm failed\n");
+        return 0;
+    }
+
+    Game game(0, 1.0, 0, dataHome);
+    for (int i = 0; i < game.buildings.size(); i++) game.buildings.setCount(i, 3);
+    game.updateLPS();
+
+    std::vector<double> cpu;
+    std::vector<double> bytes;
+    cpu.reserve(frames);
+    bytes.reserve(frames);
+    long long allocations = 0;
+    {
+        Renderer renderer(term.get());
+        renderer.render(game);
+        long long firstFrame = term.drain();
+        // ncurses sizes its scroll-optimization tables on the first incremental
+        // update; keep that one-off out of the steady-state numbers
+        game.runCycle(1.0 / 60.0);
+        renderer.render(game);
+        term.drain();
+
+        for (int f = 0; f < frames; f++) {
+            long long before = allocationCount;
+            game.runCycle(1.0 / 60.0);
+            game.updateTimers(1.0 / 60.0);
+            if (scenario == Scenario::CLICK_STORM) {
+                game.registerClicks(30);
+            } else if (scenario == Scenario::RESIZE) {
+                Size s = (f % 2) ? size : Size{size.cols - 10, size.rows - 4};
+                resize_term(s.rows, s.cols);
+                renderer.handleResize();
+            }
+
+            double t0 = threadCpuNs();
+            renderer.render(game);
+            double t1 = threadCpuNs();
+            allocations += allocationCount - before;
+            cpu.push_back(t1 - t0);
+            bytes.push_back(term.drain());
+        }
+
+        double totalBytes = 0, maxBytes = 0;
+        for (double b : bytes) {
+            totalBytes += b;
+            if (b > maxBytes) maxBytes = b;
+        }
+        printf("{\"name\":\"%s\",\"cols\":%d,\"rows\":%d,\"frames\":%d,"
+               "\"cpu_median_ns\":%.0f,\"cpu_min_ns\":%.0f,"
+               "\"bytes_first_frame\":%lld,\"bytes_per_frame_mean\":%.1f,"
+               "\"bytes_per_frame_median\":%.0f,\"bytes_per_frame_max\":%.0f,"
+               "\"allocs_per_frame\":%.2f}\n",
+               name, size.cols, size.rows, frames,
+               Bench::median(cpu), *std::min_element(cpu.begin(), cpu.end()),
+               firstFrame, totalBytes / frames, Bench::median(bytes), maxBytes,
+               (double)allocations / frames);
+        fflush(stdout);
+    }
+    term.drain();
+    return allocations;
+}
+
+}
+
+int main() {
+    std::setlocale(LC_ALL, "");
+    char tmpl[] = "/tmp/cybergrind-bench-XXXXXX";
+    if (!mkdtemp(tmpl)) {
+        fprintf(stderr, "render_bench: cannot create a scratch directory\n");
+        return 1;
+    }
+
+    // Resizing legitimately reallocates windows; the other two must not allocate
+    long long steadyAllocations = 0;
+    const Size sizes[] = {{80, 24}, {120, 40}, {200, 60}};
+    for (Size size : sizes) {
+        steadyAllocations += runScenario("render.idle", Scenario::IDLE, size, 600, tmpl);
+        steadyAllocations += runScenario("render.click_storm", Scenario::CLICK_STORM, size, 600, tmpl);
+        runScenario("render.resize", Scenario::RESIZE, size, 120, tmpl);
+    }
+    if (steadyAllocations > 0) {
+        fprintf(stderr, "render_bench: %lld heap allocations in steady-state frames\n",
+                steadyAllocations);
+        return 1;
+    }
+    return 0;
+}
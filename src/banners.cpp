@@ -0,0 +1,101 @@
+#include "banners.hpp"
+#include "banner_index.hpp"
+#include "utils.hpp"
+#include "json.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+
+using json = nlohmann::json;
+
+namespace {
+
+void splitLines(const std::string& text, std::vector<std::string>& lines) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string::npos) eol = text.size();
+        std::string line = text.substr(pos, eol - pos);
+        // Trim potential \r from Windows-style line endings
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        lines.push_back(line);
+        pos = eol + 1;
+    }
+}
+
+// The common case: one fseek and one read of a few hundred bytes
+bool readIndexed(const std::string& path, Rng& rng, std::vector<std::string>& banner) {
+    if (BANNER_COUNT == 0) return false;
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    struct stat st;
+    bool ok = fstat(fileno(f), &st) == 0 && st.st_size == BANNERS_FILE_SIZE;
+    if (ok) {
+        const BannerSpan& span = BANNER_INDEX[rng.below(BANNER_COUNT)];
+        std::string text(span.length, '\0');
+        ok = fseek(f, span.offset, SEEK_SET) == 0 && fread(text.data(), 1, span.length, f) == span.length;
+        // An edit that kept the size can still move or change this banner
+        ok = ok && bannerHash(text.data(), text.size()) == span.hash;
+        if (ok) splitLines(text, banner);
+    }
+    fclose(f);
+    return ok;
+}
+
+// banners.txt was edited after the build; split it the slow way
+bool readScanned(const std::string& path, Rng& rng, std::vector<std::string>& banner) {
+    std::ifstream bf(path);
+    if (!bf.is_open()) return false;
+
+    std::vector<std::vector<std::string>> banners;
+    std::string line;
+    std::vector<std::string> currentBanner;
+    while (std::getline(bf, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        if (line == "@@@") {
+            if (!currentBanner.empty()) {
+                banners.push_back(currentBanner);
+                currentBanner.clear();
+            }
+        } else {
+            currentBanner.push_back(line);
+        }
+    }
+    if (!currentBanner.empty()) banners.push_back(currentBanner);
+
+    if (banners.empty()) return false;
+    banner = banners[rng.below(banners.size())];
+    return true;
+}
+
+bool readAssets(Rng& rng, std::vector<std::string>& banner) {
+    std::ifstream f(Utils::getDataPath("assets.json"));
+    if (!f.is_open()) return false;
+    try {
+        json data = json::parse(f);
+        if (data.contains("splash_banners") && data["splash_banners"].is_array() &&
+            !data["splash_banners"].empty()) {
+            const json& banners = data["splash_banners"];
+            banner = banners[rng.below(banners.size())].get<std::vector<std::string>>();
+            return true;
+        } else if (data.contains("splash_banner") && data["splash_banner"].is_array()) {
+            banner = data["splash_banner"].get<std::vector<std::string>>();
+            return true;
+        }
+    } catch (...) { /* ignore */ }
+    return false;
+}
+
+}
+
+std::vector<std::string> loadSplashBanner(Rng& rng) {
+    std::vector<std::string> banner;
+    std::string bannersPath = Utils::getDataPath("banners.txt");
+    if (readIndexed(bannersPath, rng, banner)) return banner;
+    banner.clear();
+    if (readScanned(bannersPath, rng, banner)) return banner;
+    readAssets(rng, banner);
+    return banner;
+}
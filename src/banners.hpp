@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "rng.hpp"
+
+// Byte range of one banner in data/banners.txt, without its "@@@" separator,
+// and a hash of those bytes
+struct BannerSpan {
+    uint32_t offset;
+    uint32_t length;
+    uint64_t hash;
+};
+
+// FNV-1a; tools/gen_banner_index fills BannerSpan::hash with the same function
+inline uint64_t bannerHash(const char* data, size_t length) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < length; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Picks a splash banner with the given stream and reads just that one, using
+// the offset index generated from data/banners.txt at build time. If the
+// installed file's size or the banner's bytes don't match the index, the file
+// is scanned in full instead, and assets.json is the last resort. Returns no lines if nothing is found.
+std::vector<std::string> loadSplashBanner(Rng& rng);
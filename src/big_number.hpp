@@ -0,0 +1,142 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+// DATA amounts that outgrow double: value = m * 2^e, where e is a multiple of
+// 512 and m keeps its own binary exponent in [-256, 256). Anything between
+// 1e-77 and 1e77 therefore has e == 0 and is just the double, so the usual
+// case is plain double arithmetic plus one range check on the result. Scaling
+// by a power of two is exact, so within double's range every operation rounds
+// exactly as the same double expression would; a field can switch to BigNum
+// without changing a single result, and past 1.8e308 numbers keep growing
+// instead of turning into inf.
+class BigNum {
+public:
+    constexpr BigNum() : m(0), e(0) {}
+    // Implicit, so doubles mix in freely
+    BigNum(double x) : m(x), e(0) { check(); }
+
+    // m * 2^e for any finite m and any e
+    static BigNum fromParts(double m, int64_t e) {
+        BigNum r;
+        r.m = m;
+        r.e = e;
+        r.normalize();
+        return r;
+    }
+
+    double mantissa() const { return m; }
+    int64_t exponent() const { return e; }
+    bool isZero() const { return m == 0; }
+    bool isFinite() const { return std::isfinite(m); }
+
+    // inf (with the sign) once the value is past double's range
+    double toDouble() const {
+        if (e == 0) return m;
+        if (e > 1024) return m * INFINITY;
+        if (e < -1024) return m * 0.0;
+        // Two exact steps of 2^±512, so only the last one can round
+        double half = e > 0 ? 0x1p512 : 0x1p-512;
+        return e == STEP || e == -STEP ? m * half : m * half * half;
+    }
+
+    double log10() const { return std::log10(std::abs(m)) + (double)e * 0.301029995663981195; }
+    double log() const { return std::log(std::abs(m)) + (double)e * 0.693147180559945309; }
+
+    // base^n for base > 0. std::pow while it fits in a double (so the result
+    // is bit-identical to it); beyond, squaring for whole n and the log domain
+    // otherwise.
+    static BigNum pow(double base, double n) {
+        double r = std::pow(base, n);
+        if (std::isfinite(r) && r >= 0x1p-1022) return BigNum(r);
+        if (n == std::floor(n) && std::abs(n) < 0x1p53) {
+            double half = std::floor(n / 2);
+            BigNum h = pow(base, half);
+            return h * h * BigNum(std::pow(base, n - 2 * half));
+        }
+        double l2 = n * std::log2(base);
+        double whole = std::floor(l2);
+        return fromParts(std::exp2(l2 - whole), (int64_t)whole);
+    }
+
+    friend BigNum operator+(BigNum a, BigNum b) {
+        if (a.e == b.e) return BigNum(a.m + b.m, a.e);
+        if (b.m == 0) return a;
+        if (a.m == 0) return b;
+        if (a.e < b.e) std::swap(a, b);
+        // A step apart b is still exact after scaling; two or more and it is
+        // far below half an ulp of a, so double addition would return a too
+        if (a.e - b.e > STEP) return a;
+        return BigNum(a.m + b.m * 0x1p-512, a.e);
+    }
+    friend BigNum operator-(BigNum a, BigNum b) { return a + -b; }
+    friend BigNum operator*(BigNum a, BigNum b) { return BigNum(a.m * b.m, a.e + b.e); }
+    friend BigNum operator/(BigNum a, BigNum b) { return BigNum(a.m / b.m, a.e - b.e); }
+    BigNum operator-() const {
+        BigNum r = *this;
+        r.m = -r.m;
+        return r;
+    }
+    friend BigNum abs(BigNum a) {
+        a.m = std::abs(a.m);
+        return a;
+    }
+    BigNum& operator+=(BigNum b) { return *this = *this + b; }
+    BigNum& operator-=(BigNum b) { return *this = *this - b; }
+    BigNum& operator*=(BigNum b) { return *this = *this * b; }
+    BigNum& operator/=(BigNum b) { return *this = *this / b; }
+
+    // Each value has one representation, so the same exponent compares the
+    // mantissas and otherwise sign, then exponent decide. Zero, inf and NaN
+    // all have e == 0 and compare as doubles.
+    friend bool operator<(BigNum a, BigNum b) {
+        if (a.e == b.e) return a.m < b.m;
+        if (!std::isfinite(a.m) || !std::isfinite(b.m)) return a.m < b.m;
+        int sa = sign(a.m), sb = sign(b.m);
+        if (sa != sb) return sa < sb;
+        return sa > 0 ? a.e < b.e : a.e > b.e;
+    }
+    friend bool operator>(BigNum a, BigNum b) { return b < a; }
+    friend bool operator<=(BigNum a, BigNum b) { return a < b || a == b; }
+    friend bool operator>=(BigNum a, BigNum b) { return b <= a; }
+    friend bool operator==(BigNum a, BigNum b) { return a.m == b.m && a.e == b.e; }
+
+private:
+    static constexpr int64_t STEP = 512;
+    static constexpr int HALF_STEP = 256;
+
+    double m;
+    int64_t e;
+
+    BigNum(double m, int64_t e) : m(m), e(e) { check(); }
+
+    static int sign(double x) { return (x > 0) - (x < 0); }
+
+    // Binary exponent of m, or a value outside the window for 0, inf and NaN
+    static int binaryExponent(double x) {
+        return (int)((std::bit_cast<uint64_t>(x) >> 52) & 0x7ff) - 1023;
+    }
+
+    // The one branch on the fast path: is m still inside its window?
+    void check() {
+        int be = binaryExponent(m);
+        if (be < -HALF_STEP || be >= HALF_STEP) [[unlikely]] normalize();
+    }
+
+    void normalize() {
+        if (m == 0 || !std::isfinite(m)) {
+            e = 0;
+            return;
+        }
+        int ex;
+        double frac = std::frexp(m, &ex);   // m = frac * 2^ex, frac in [0.5, 1)
+        int64_t total = e + ex - 1;         // binary exponent of the value
+        int64_t k = total + HALF_STEP;
+        k = (k >= 0 ? k / STEP : -((-k + STEP - 1) / STEP)) * STEP;
+        m = std::ldexp(frac, (int)(total - k + 1));
+        e = k;
+    }
+};
@@ -0,0 +1,157 @@
+#include "building.hpp"
+#include <cmath>
+#include <algorithm>
+
+void BuildingTable::clear() {
+    basecost.clear();
+    baselps.clear();
+    nextCost.clear();
+    count.clear();
+    ids.clear();
+    names.clear();
+    maxMemo.clear();
+    cheapestMemo.n = 0;
+}
+
+void BuildingTable::add(int id, const std::string& name, double cost, double lps) {
+    basecost.push_back(cost);
+    baselps.push_back(lps);
+    nextCost.push_back(cost);
+    count.push_back(0);
+    ids.push_back(id);
+    names.push_back(name);
+    maxMemo.push_back({NAN, NAN, 0, 0});
+    cheapestMemo.n = 0;
+}
+
+void BuildingTable::setCount(int i, int n) {
+    this->count[i] = n;
+    this->nextCost[i] = this->basecost[i] * this->costPowers(n);
+    this->maxMemo[i].low = NAN;
+    this->cheapestMemo.n = 0;
+}
+
+BigNum BuildingTable::seriesOf(int n) const {
+    return this->costPowers(n) - 1;
+}
+
+BigNum BuildingTable::cachedSeriesOf(int n) const {
+    if (n != memoSeriesN) {
+        memoSeriesN = n;
+        memoSeries = seriesOf(n);
+    }
+    return memoSeries;
+}
+
+BigNum BuildingTable::getCostOf(int i, int n) const {
+    if (n <= 0) return 0;
+    return this->nextCost[i] * seriesOf(n) / (COST_SCALE_FACTOR - 1);
+}
+
+BigNum BuildingTable::getRefundOf(int i, int n) const {
+    if (n > this->count[i]) n = this->count[i];
+    if (n <= 0) return 0;
+    return this->basecost[i] * this->costPowers(this->count[i] - n)
+         * seriesOf(n) / (COST_SCALE_FACTOR - 1);
+}
+
+int BuildingTable::getMaxAffordable(int i, BigNum funds) const {
+    MaxMemo& m = this->maxMemo[i];
+    if (m.low <= funds && funds < m.high) return m.n;
+
+    int n = computeMaxAffordable(i, funds);
+    // The answer only changes once funds reach the next copy, or drop below
+    // the last one (or below the next cost, which gates buying at all)
+    BigNum next = this->nextCost[i];
+    if (n == 0) {
+        m.low = -INFINITY;
+        m.high = std::max(next, getCostOf(i, 1));
+    } else {
+        m.low = std::max(next, getCostOf(i, n));
+        m.high = n < MAX_BULK_PURCHASE ? getCostOf(i, n + 1) : INFINITY;
+    }
+    m.n = n;
+    m.cost = getCostOf(i, n > 0 ? n : 1);
+    return n;
+}
+
+int BuildingTable::computeMaxAffordable(int i, BigNum funds) const {
+    BigNum next = this->nextCost[i];
+    if (!(funds >= next)) return 0;
+    double est = (funds * (COST_SCALE_FACTOR - 1) / next + 1).log() / std::log(COST_SCALE_FACTOR);
+    int n = (int)std::min(std::floor(est), (double)MAX_BULK_PURCHASE);
+    // The logs can be off by an ulp either way; settle on the exact boundary
+    while (n > 0 && this->getCostOf(i, n) > funds) n--;
+    while (n < MAX_BULK_PURCHASE && this->getCostOf(i, n + 1) <= funds) n++;
+    return n;
+}
+
+double BuildingTable::totalRate() const {
+    const double* lps = this->baselps.data();
+    const int* owned = this->count.data();
+    int len = size();
+    double sum[4] = {0, 0, 0, 0};
+    int i = 0;
+    for (; i + 4 <= len; i += 4) {
+        for (int k = 0; k < 4; k++) sum[k] += lps[i + k] * owned[i + k];
+    }
+    for (; i < len; i++) sum[i & 3] += lps[i] * owned[i];
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+void BuildingTable::costsOf(int n, BigNum funds, int first, int last, BigNum* out) const {
+    if (n == BUY_MAX) {
+        for (int i = first; i < last; i++) {
+            getMaxAffordable(i, funds);
+            out[i - first] = this->maxMemo[i].cost;
+        }
+        return;
+    }
+    if (n <= 0) {
+        std::fill(out, out + (last - first), BigNum());
+        return;
+    }
+    const BigNum* next = this->nextCost.data();
+    BigNum series = cachedSeriesOf(n);
+    for (int i = first; i < last; i++) {
+        out[i - first] = next[i] * series / (COST_SCALE_FACTOR - 1);
+    }
+}
+
+// A batch for BUY_MAX is affordable exactly when a single copy is, so both
+// passes below price it as one copy
+void BuildingTable::affordable(int n, BigNum funds, int first, int last, uint8_t* mask) const {
+    if (n == BUY_MAX) n = 1;
+    if (n <= 0) {
+        std::fill(mask, mask + (last - first), 1);
+        return;
+    }
+    const BigNum* next = this->nextCost.data();
+    BigNum series = cachedSeriesOf(n);
+    for (int i = first; i < last; i++) {
+        mask[i - first] = next[i] * series / (COST_SCALE_FACTOR - 1) <= funds;
+    }
+}
+
+BigNum BuildingTable::cheapestAbove(int n, BigNum funds) const {
+    if (n == BUY_MAX) n = 1;
+    if (n <= 0) return INFINITY;
+    // Nothing is priced in [floor, best), so the answer holds until funds
+    // leave that range
+    CheapestMemo& c = this->cheapestMemo;
+    if (c.n == n && c.floor <= funds && funds < c.best) return c.best;
+
+    const BigNum* next = this->nextCost.data();
+    BigNum series = cachedSeriesOf(n);
+    BigNum best = INFINITY, floor = -INFINITY;
+    for (int i = 0; i < size(); i++) {
+        BigNum cost = next[i] * series / (COST_SCALE_FACTOR - 1);
+        if (cost > funds) {
+            if (cost < best) best = cost;
+        } else if (cost > floor) {
+            floor = cost;
+        }
+    }
+    c = {floor, best, n};
+    return best;
+}
@@ -1,16 +1,91 @@
 #pragma once
 
 #include <string>
-#include <cmath>
+#include <vector>
+#include <cstdint>
 #include "constants.hpp"
+#include "big_number.hpp"
+#include "power_table.hpp"
 
-struct Building {
-    std::string name;
-    double basecost;
-    double baselps;
-    int count;
+// The building catalog and how many of each the player owns, stored as
+// parallel arrays. The numeric fields every frame touches are contiguous, so
+// whole-table passes (total rate, costs, affordability) are straight loops;
+// names and ids sit apart and are only read for the rows actually shown.
+// Costs are BigNum, since they grow geometrically and leave double's range
+// long before rates do. nextCost is kept in step with count, powers of
+// COST_SCALE_FACTOR come from a table, and buy-max answers are memoized per
+// row, so std::log runs when a count changes or funds cross a price, not on
+// every frame.
+class BuildingTable {
+public:
+    int size() const { return (int)ids.size(); }
+    bool empty() const { return ids.empty(); }
+    void clear();
+    void add(int id, const std::string& name, double basecost, double baselps);
 
-    double getNextCost() const {
-        return this->basecost * std::pow(COST_SCALE_FACTOR, this->count);
-    }
+    // Cold data
+    const std::string& getName(int i) const { return names[i]; }
+    int getId(int i) const { return ids[i]; }
+
+    // Hot data
+    double getBaseCost(int i) const { return basecost[i]; }
+    double getBaseLps(int i) const { return baselps[i]; }
+    int getCount(int i) const { return count[i]; }
+    void setCount(int i, int n);
+    BigNum getNextCost(int i) const { return nextCost[i]; }
+
+    // Total for the next n copies: a geometric series starting at getNextCost()
+    BigNum getCostOf(int i, int n) const;
+    // What the last n copies cost to buy, used as the basis for refunds
+    BigNum getRefundOf(int i, int n) const;
+    // Most copies funds can pay for, from inverting getCostOf
+    int getMaxAffordable(int i, BigNum funds) const;
+
+    // -- Whole-table kernels -- //
+    // Sum of baselps * count. Four fixed partial sums, so the order (and the
+    // result) doesn't depend on how the compiler vectorizes it.
+    double totalRate() const;
+    // Price of buying n of each building in [first, last) into out. BUY_MAX
+    // prices the affordable batch, or a single copy when none is affordable.
+    void costsOf(int n, BigNum funds, int first, int last, BigNum* out) const;
+    // mask[i - first] = 1 if at least one batch of n (one copy for BUY_MAX)
+    // of building i is affordable
+    void affordable(int n, BigNum funds, int first, int last, uint8_t* mask) const;
+    // Cheapest batch of n over the whole table that funds can't cover yet, or
+    // infinity if there is none. Memoized until funds cross a price.
+    BigNum cheapestAbove(int n, BigNum funds) const;
+
+private:
+    std::vector<double> basecost;
+    std::vector<double> baselps;
+    std::vector<BigNum> nextCost;   // basecost * COST_SCALE_FACTOR^count; outgrows double
+    std::vector<int> count;
+    std::vector<int> ids;           // stable across catalog reorders; saves refer to buildings by this
+    std::vector<std::string> names;
+
+    // getMaxAffordable's answer for a row, valid while funds stays in
+    // [low, high). A NaN low marks it stale.
+    struct MaxMemo {
+        BigNum low;
+        BigNum high;
+        BigNum cost;                // getCostOf for the answer, or for 1 if it is 0
+        int n;
+    };
+    mutable std::vector<MaxMemo> maxMemo;
+    // cheapestAbove's answer for batch size n (0 when stale)
+    struct CheapestMemo {
+        BigNum floor;               // dearest price funds already cover
+        BigNum best;
+        int n = 0;
+    };
+    mutable CheapestMemo cheapestMemo;
+    // The shop asks for the same batch size every frame
+    mutable int memoSeriesN = 0;
+    mutable BigNum memoSeries = 0;
+    PowerTable costPowers{COST_SCALE_FACTOR};
+
+    // Numerator of the geometric series for n copies; the same for every row
+    BigNum seriesOf(int n) const;
+    BigNum cachedSeriesOf(int n) const;
+    int computeMaxAffordable(int i, BigNum funds) const;
 };
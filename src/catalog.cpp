@@ -0,0 +1,8 @@
+#include "catalog.hpp"
+#include "catalog_data.hpp" // generated into the build directory by tools/gen_catalog
+
+static_assert(isValidCatalog(BUILTIN_CATALOG), "data/buildings.json failed catalog validation");
+
+std::span<const CatalogEntry> builtinCatalog() {
+    return BUILTIN_CATALOG;
+}
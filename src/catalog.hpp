@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+// One row of the building catalog as compiled into the binary
+struct CatalogEntry {
+    int id;
+    const char* name;
+    double basecost;
+    double baselps;
+};
+
+// Ids index a lookup table (Game::indexById), so they are kept small
+constexpr int MAX_CATALOG_ID = 1 << 20;
+
+// Rules every catalog has to satisfy; checked with static_assert on the
+// built-in one and at runtime on an override file
+constexpr bool isValidCatalog(std::span<const CatalogEntry> entries) {
+    if (entries.empty()) return false;
+    for (size_t i = 0; i < entries.size(); i++) {
+        const CatalogEntry& e = entries[i];
+        if (e.id < 0 || e.id >= MAX_CATALOG_ID || !e.name || !e.name[0]) return false;
+        // Rejects NaN and infinities as well (x - x is NaN for both)
+        if (!(e.basecost > 0) || !(e.basecost - e.basecost == 0)) return false;
+        if (!(e.baselps >= 0) || !(e.baselps - e.baselps == 0)) return false;
+        for (size_t j = 0; j < i; j++) {
+            if (entries[j].id == e.id) return false;
+        }
+    }
+    return true;
+}
+
+// The catalog generated from data/buildings.json at build time
+std::span<const CatalogEntry> builtinCatalog();
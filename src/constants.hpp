@@ -9,12 +9,21 @@ const double LPS_TO_CLICK_COST_SCALE_FACTOR = 1.8;
 const double AUTOSAVE_INTERVAL = 30.0;
 const double CACHE_BUFF_DURATION = 10.0;
 const double CACHE_BUFF_PERCENT = 777.0;
+const double SELL_REFUND_RATE = 0.5;    // fraction of the purchase price returned on sale
 
 // -- System Constants -- //
 #ifndef DATA_DIR
 #define DATA_DIR "./data"
 #endif
 
-const int VERSION = 1;
-const std::string SAVE_FILE_NAME = "save_data.json";
-const int EYE_CANDY_LOG_SIZE = 4;
\ No newline at end of file
+const int VERSION = 4;
+const char* const SAVE_FILE_NAME = "save_data.bin";
+const char* const LEGACY_SAVE_FILE_NAME = "save_data.json"; // VERSION 1, migrated on load
+const int EYE_CANDY_LOG_SIZE = 4;
+const int LOG_SCROLLBACK = 256;         // log entries kept by default, --log-lines to change
+const int MAX_LOG_SCROLLBACK = 65536;   // upper bound on --log-lines (3 MB of entries)
+const int BUY_MAX = -1;                 // buy/sell amount meaning "as many as possible"
+const int MAX_BULK_PURCHASE = 1000000;
+const double MIN_FRAME_INTERVAL = 1.0 / 60.0; // cap on redraw rate while things are changing
+const double MAX_IDLE_WAIT = 1.0;             // longest the main loop sleeps with nothing pending
+const double HOLD_BREACH_RATE = 15.0;         // breaches per second while space is held (--hold-breach)
\ No newline at end of file
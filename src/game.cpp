@@ -2,118 +2,197 @@
 #include <fstream>
 #include <cstdlib>
 #include <random>
+#include <chrono>
 #include "json.hpp"
+#include "catalog.hpp"
 #include "utils.hpp"
+#include "trace.hpp"
 
 using json = nlohmann::json;
 
-Game::Game(double lps, double b) 
+namespace {
+
+uint64_t randomSeed() {
+    std::random_device rd;
+    uint64_t seed = ((uint64_t)rd() << 32) ^ rd() ^
+                    (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    return seed ? seed : 1;
+}
+
+}
+
+Game::Game(double lps, double b, uint64_t seed, const std::string& dataHome)
     : linesPerSecond(lps), lines(0), buffs(b), baseClickAmt(1.0),
       lpsToClick(0), clickBoostPercent(1.0), lastClickValue(0), feedbackTimer(0),
       autosaveTimer(0), autosaveFeedbackTimer(0), buffsBought(0), clickSharesBought(0),
-      cacheActiveTimer(0), cacheBuffDurationTimer(0), cacheOnScreen(false), activeAlert("") {
-    
+      cacheActiveTimer(0), cacheBuffDurationTimer(0), cacheOnScreen(false), activeAlert(""),
+      seed(seed ? seed : randomSeed()), rng(this->seed, RNG_GAMEPLAY),
+      eyeCandyRng(this->seed, RNG_EYE_CANDY) {
+
     loadBuildings();
-    this->cacheSpawnTimer = std::rand() % 300;
+    saveWriter = std::make_unique<SaveWriter>(Utils::getSavePath(dataHome));
+    this->cacheSpawnTimer = rng.below(300);
 }
 
 void Game::loadBuildings() {
-    std::string path = Utils::getDataPath("buildings.json");
+    this->buildings.clear();
+    for (const CatalogEntry& e : builtinCatalog()) {
+        this->buildings.add(e.id, e.name, e.basecost, e.baselps);
+    }
+    indexBuildings();
+}
+
+bool Game::loadBuildings(const std::string& path) {
     std::ifstream f(path);
-    if (f.is_open()) {
-        try {
-            json data = json::parse(f);
-            this->buildings.clear();
-            for (const auto& item : data) {
-                this->buildings.push_back({
-                    item.at("name").get<std::string>(),
-                    item.at("basecost").get<double>(),
-                    item.at("baselps").get<double>(),
-                    0
-                });
-            }
-        } catch (const std::exception& e) {
-            // fallback if json is malformed
+    if (!f.is_open()) return false;
+
+    std::vector<std::string> names;
+    std::vector<CatalogEntry> entries;
+    try {
+        json data = json::parse(f);
+        if (!data.is_array()) return false;
+        for (const auto& item : data) {
+            names.push_back(item.at("name").get<std::string>());
+            entries.push_back({item.value("id", (int)entries.size()), nullptr,
+                               item.at("basecost").get<double>(), item.at("baselps").get<double>()});
         }
+    } catch (const std::exception& e) {
+        return false;
     }
-    
-    // Fallback if file not found or empty
-    if (this->buildings.empty()) {
-        buildings.push_back({"BUILDING LOAD ERROR", 404, 0.1, 0});
+    for (size_t i = 0; i < entries.size(); i++) entries[i].name = names[i].c_str();
+    if (!isValidCatalog(entries)) return false;
+
+    this->buildings.clear();
+    for (size_t i = 0; i < entries.size(); i++) {
+        this->buildings.add(entries[i].id, names[i], entries[i].basecost, entries[i].baselps);
     }
+    indexBuildings();
+    return true;
+}
 
+void Game::indexBuildings() {
     this->numBuildings = buildings.size();
+    this->indexById.clear();
+    for (int i = 0; i < numBuildings; i++) {
+        int id = buildings.getId(i);
+        if (id < 0) continue;
+        if (id >= (int)indexById.size()) indexById.resize(id + 1, -1);
+        indexById[id] = i;
+    }
 }
 
 void Game::updateLPS() {
-    double newlps = 0;
-    for (const auto& b : this->buildings) {
-        newlps += b.baselps * b.count;
-    }
-    this->linesPerSecond = newlps;
+    this->linesPerSecond = this->buildings.totalRate();
+    invalidateEconomy(ECON_RATE | ECON_CLICK);
 }
 
-void Game::buyBuilding(int index) {
-    if (index >= numBuildings) {
+void Game::buyBuilding(int index, int n) {
+    if (index < 0 || index >= numBuildings) {
         return;
     }
-    double cost = buildings[index].getNextCost();
+    BuildingTable& b = this->buildings;
+    if (n == BUY_MAX) n = b.getMaxAffordable(index, this->lines);
+    if (n <= 0) return;
+
+    BigNum cost = b.getCostOf(index, n);
     if (cost <= this->lines) {
-        this->buildings[index].count++;
+        b.setCount(index, b.getCount(index) + n);
         this->lines -= cost;
-        addLog("SYSTEM: Purchased [" + buildings[index].name + "]");
+        addLog({.kind = LogKind::PURCHASED, .building = b.getId(index), .count = n});
         updateLPS();
     }
 }
 
-double Game::getBuffCost() const {
-    return 1000.0 * std::pow(BUFF_COST_SCALE_FACTOR, this->buffsBought);
+void Game::sellBuilding(int index, int n) {
+    if (index < 0 || index >= numBuildings) {
+        return;
+    }
+    BuildingTable& b = this->buildings;
+    if (n == BUY_MAX || n > b.getCount(index)) n = b.getCount(index);
+    if (n <= 0) return;
+
+    BigNum refund = b.getRefundOf(index, n) * SELL_REFUND_RATE;
+    b.setCount(index, b.getCount(index) - n);
+    this->lines += refund;
+    addLog({.kind = LogKind::SOLD, .building = b.getId(index), .count = n, .value = refund});
+    updateLPS();
 }
 
-double Game::getClickShareCost() const {
-    return 500.0 * std::pow(LPS_TO_CLICK_COST_SCALE_FACTOR, this->clickSharesBought);
+const Economy& Game::economy() const {
+    uint8_t dirty = this->economyDirty;
+    if (dirty == 0) return this->cachedEconomy;
+    Economy& e = this->cachedEconomy;
+    if (dirty & ECON_RATE) e.rate = this->linesPerSecond * this->buffs;
+    if (dirty & ECON_BUFF_COST) e.buffCost = 1000.0 * this->buffPowers(this->buffsBought);
+    if (dirty & ECON_SHARE_COST) {
+        e.clickShareCost = 500.0 * this->sharePowers(this->clickSharesBought);
+    }
+    if (dirty & (ECON_RATE | ECON_CLICK)) {
+        e.clickValue = (this->baseClickAmt + e.rate * this->lpsToClick) * this->clickBoostPercent;
+    }
+    this->economyDirty = 0;
+    return e;
 }
 
 void Game::buyBuff() {
-    double nextCost = this->getBuffCost();
+    BigNum nextCost = this->getBuffCost();
     if (this->lines >= nextCost) {
         this->lines -= nextCost;
         this->buffs += 0.1;
         this->buffsBought++;
-        addLog("SYSTEM: Overclock updated to x" + std::to_string(this->buffs).substr(0,4));
+        invalidateEconomy(ECON_RATE | ECON_BUFF_COST | ECON_CLICK);
+        addLog({.kind = LogKind::OVERCLOCK, .value = this->buffs});
         this->updateLPS();
     }
 }
 
 void Game::buyClickShare() {
-    double nextCost = this->getClickShareCost();
+    BigNum nextCost = this->getClickShareCost();
     if (this->lines >= nextCost) {
         this->lines -= nextCost;
         this->lpsToClick += 0.01;
         this->clickSharesBought++;
-        addLog("SYSTEM: Click Share increased to " + std::to_string(int(this->lpsToClick * 100)) + "%");
+        invalidateEconomy(ECON_SHARE_COST | ECON_CLICK);
+        addLog({.kind = LogKind::CLICK_SHARE, .count = int(this->lpsToClick * 100)});
     }
 }
 
 void Game::runCycle(double deltat) {
-    this->lines += this->linesPerSecond * deltat * this->buffs;
+    TRACE_SCOPE("Game::runCycle");
+    credit(economy().rate * deltat);
+}
+
+// Kahan summation with Neumaier's branch for amounts bigger than the total,
+// on BigNum so it keeps working past double's range
+void Game::credit(BigNum amount) {
+    BigNum y = amount + this->linesCarry;
+    BigNum t = this->lines + y;
+    if (abs(this->lines) >= abs(y)) this->linesCarry = (this->lines - t) + y;
+    else this->linesCarry = (y - t) + this->lines;
+    this->lines = t;
 }
 
 void Game::registerClick() {
-    double lps = this->linesPerSecond * this->buffs;
-    double lpsContribution = lps * this->lpsToClick;
-    double linesToAdd = (this->baseClickAmt + lpsContribution) * this->clickBoostPercent;
-    this->lines += linesToAdd;
-    this->lastClickValue = linesToAdd;
+    registerClicks(1);
+}
+
+// A burst of breaches (everything drained in one frame, or one hold tick)
+// is credited in one step with a single log entry
+void Game::registerClicks(int n) {
+    TRACE_SCOPE("Game::registerClicks");
+    if (n <= 0) return;
+    double linesPerClick = economy().clickValue;
+    double linesToAdd = linesPerClick * n;
+    credit(linesToAdd);
+    this->lastClickValue = linesPerClick;
     this->feedbackTimer = 0.35f;
 
     // Random hex-like packet capture for the log
-    char hex[9];
-    sprintf(hex, "%08X", (unsigned int)(std::rand() % 0xFFFFFFFF));
-    addLog("PKT: [" + std::string(hex) + "] captured (" + Utils::formatNumber((linesToAdd)) + " DATA)");
+    addLog({.kind = LogKind::PACKET, .count = n, .packet = eyeCandyRng.next32(), .value = linesToAdd});
 }
 
 void Game::updateTimers(double dt) {
+    TRACE_SCOPE("Game::updateTimers");
     this->lastdeltat = dt;
     if (this->feedbackTimer > 0) this->feedbackTimer -= dt;
     if (this->autosaveFeedbackTimer > 0) this->autosaveFeedbackTimer -= dt;
@@ -125,13 +204,14 @@ void Game::updateTimers(double dt) {
         this->autosaveFeedbackTimer = 2.0;
         // In Game::updateTimers we can't easily add a log from saveGame because it's const, 
         // but we can add it here.
-        addLog("SYSTEM: Auto-save complete.");
+        addLog({.kind = LogKind::AUTOSAVED});
     }
     if (this->cacheBuffDurationTimer > 0) {
         this->cacheBuffDurationTimer -= dt;
         if (this->cacheBuffDurationTimer <= 0) {
             this->clickBoostPercent = 1.0;
             this->activeAlert = "";
+            invalidateEconomy(ECON_CLICK);
         }
     }
     if (!this->cacheOnScreen) {
@@ -144,96 +224,216 @@ void Game::updateTimers(double dt) {
         this->cacheActiveTimer -= dt;
         if (this->cacheActiveTimer <= 0) {
             this->cacheOnScreen = false;
-            this->cacheSpawnTimer = 300 + (std::rand() % 100); 
+            this->cacheSpawnTimer = 300 + rng.below(100);
         }
     }
 }
 
-void Game::saveGame() {
-    json save_data;
-    save_data["version"] = VERSION;
-    save_data["lines"] = this->lines;
-    save_data["buffs"] = this->buffs;
-    save_data["linesPerSecond"] = this->linesPerSecond;
-    save_data["buffsBought"] = this->buffsBought;
-    save_data["clickSharesBought"] = this->clickSharesBought;
-    save_data["lpsToClick"] = this->lpsToClick;
+// Seconds until updateTimers next changes something: autosave, a feedback
+// fade, the cache buff running out, or the cache spawning/expiring.
+double Game::nextTimerDeadline() const {
+    double next = AUTOSAVE_INTERVAL - this->autosaveTimer;
+    auto consider = [&next](double t) {
+        if (t > 0 && t < next) next = t;
+    };
+    consider(this->feedbackTimer);
+    consider(this->autosaveFeedbackTimer);
+    consider(this->cacheBuffDurationTimer);
+    consider(this->cacheOnScreen ? this->cacheActiveTimer : this->cacheSpawnTimer);
+    return next > 0 ? next : 0;
+}
 
-    json buildings_data = json::array();
-    for (const auto& b : this->buildings) {
-        buildings_data.push_back({
-            {"name", b.name},
-            {"count", b.count}
-        });
-    }
-    save_data["buildings"] = buildings_data;
+void Game::saveGame() {
+    TRACE_SCOPE("Game::saveGame");
+    // Snapshot only; serialization and disk IO happen on the writer thread
+    saveWriter->submit(snapshot());
+    addLog({.kind = LogKind::SAVED});
+}
 
-    std::ofstream saveFile(Utils::getSavePath());
-    if (saveFile.is_open()) {
-        saveFile << save_data.dump(4);
-        saveFile.close();
+SaveSnapshot Game::snapshot() const {
+    SaveSnapshot snap;
+    SaveState& s = snap.state;
+    s = SaveState{};
+    // A double while it fits, else the mantissa with the power of two apart
+    bool fits = std::isfinite(this->lines.toDouble());
+    s.lines = fits ? this->lines.toDouble() : this->lines.mantissa();
+    s.linesScale = fits ? 0 : this->lines.exponent();
+    s.buffs = this->buffs;
+    s.linesPerSecond = this->linesPerSecond;
+    s.lpsToClick = this->lpsToClick;
+    s.cacheBuffDurationTimer = this->cacheBuffDurationTimer;
+    s.clickBoostPercent = this->clickBoostPercent;
+    s.timestamp = std::chrono::duration<double>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    s.buffsBought = this->buffsBought;
+    s.clickSharesBought = this->clickSharesBought;
+    snprintf(s.activeAlert, sizeof(s.activeAlert), "%s", this->activeAlert.c_str());
+    s.rngSeed = this->seed;
+    for (int i = 0; i < 4; i++) s.rngState[i] = rng.state()[i];
+    snap.buildings.reserve(this->buildings.size());
+    for (int i = 0; i < this->buildings.size(); i++) {
+        snap.buildings.push_back({(uint32_t)this->buildings.getId(i), this->buildings.getCount(i)});
     }
-    addLog("SYSTEM: Saved state.");
+    return snap;
 }
 
 void Game::loadGame() {
-    std::ifstream saveFile(Utils::getSavePath());
-    if (!saveFile.is_open()) return;
+    TRACE_SCOPE("Game::loadGame");
+    // Don't read a save that is still being written
+    saveWriter->flush();
 
-    try {
-        json save_data = json::parse(saveFile);
-        
-        int savedver = save_data.value("version", 0);
-        if (savedver != VERSION) {
-            addLog("SYSTEM RESET: Save data version mismatch! Reset to defaults.");
+    SaveSnapshot snap;
+    int savedver = 0;
+    SaveReadStatus status = readSave(saveWriter->path(), snap, savedver);
+    bool migrated = false;
+    if (status == SaveReadStatus::MISSING) {
+        status = readLegacySave(saveWriter->legacyPath(), this->buildings, snap);
+        savedver = 1;
+        migrated = status == SaveReadStatus::LOADED;
+    }
+
+    switch (status) {
+        case SaveReadStatus::MISSING:
+            return;
+        case SaveReadStatus::VERSION_MISMATCH:
+            addLog({.kind = LogKind::VERSION_MISMATCH});
             return;
+        case SaveReadStatus::CORRUPT:
+            addLog({.kind = LogKind::CORRUPT});
+            return;
+        case SaveReadStatus::LOADED:
+            break;
+    }
+
+    applySnapshot(snap);
+    addLog({.kind = LogKind::RECOVERED, .count = savedver});
+
+    // Saves from before timestamps were recorded get no offline credit
+    if (snap.state.timestamp > 0) {
+        double now = std::chrono::duration<double>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        applyOfflineProgress(now - snap.state.timestamp);
+    }
+
+    if (migrated) {
+        // Write the binary save right away; the JSON file is left untouched
+        saveGame();
+        addLog({.kind = LogKind::MIGRATED, .count = VERSION});
+    }
+}
+
+void Game::applySnapshot(const SaveSnapshot& snap) {
+    const SaveState& s = snap.state;
+    this->lines = BigNum::fromParts(s.lines, s.linesScale);
+    this->linesCarry = 0;
+    this->buffs = s.buffs;
+    this->linesPerSecond = s.linesPerSecond;
+    this->buffsBought = s.buffsBought;
+    this->clickSharesBought = s.clickSharesBought;
+    this->lpsToClick = s.lpsToClick;
+    this->cacheBuffDurationTimer = s.cacheBuffDurationTimer;
+    this->clickBoostPercent = s.clickBoostPercent;
+    this->activeAlert = s.activeAlert;
+    invalidateEconomy();
+    // Older saves have no seed; they keep this session's and save it from now on
+    if (s.rngSeed != 0) {
+        this->seed = s.rngSeed;
+        this->rng.setState(s.rngState);
+        this->eyeCandyRng = Rng(this->seed, RNG_EYE_CANDY);
+    }
+
+    for (const auto& sb : snap.buildings) {
+        if (sb.id < indexById.size() && indexById[sb.id] >= 0) {
+            this->buildings.setCount(indexById[sb.id], sb.count);
         }
+    }
+    updateLPS();
+}
+
+void Game::applyOfflineProgress(double elapsed) {
+    // Wall clock can jump backwards; never take DATA away
+    if (elapsed <= 0) return;
+
+    // Production doesn't depend on the cache buff (it only boosts clicks), so
+    // the whole interval is credited in one step. The buff timer is just split
+    // into the part that ran out while closed and whatever is left of it.
+    double earned = economy().rate * elapsed;
+    credit(earned);
 
-        this->lines = save_data.value("lines", 0.0);
-        this->buffs = save_data.value("buffs", 1.0);
-        this->linesPerSecond = save_data.value("linesPerSecond", 0.0);
-        this->buffsBought = save_data.value("buffsBought", 0);
-        this->clickSharesBought = save_data.value("clickSharesBought", 0);
-        this->lpsToClick = save_data.value("lpsToClick", 0.0);
-
-        if (save_data.contains("buildings") && save_data["buildings"].is_array()) {
-            for (const auto& b_data : save_data["buildings"]) {
-                std::string name = b_data.value("name", "");
-                int count = b_data.value("count", 0);
-
-                for (auto& b : this->buildings) {
-                    if (b.name == name) {
-                        b.count = count;
-                        break;
-                    }
-                }
-            }
+    if (this->cacheBuffDurationTimer > 0) {
+        this->cacheBuffDurationTimer -= elapsed;
+        if (this->cacheBuffDurationTimer <= 0) {
+            this->cacheBuffDurationTimer = 0;
+            this->clickBoostPercent = 1.0;
+            this->activeAlert = "";
+            invalidateEconomy(ECON_CLICK);
         }
+    }
 
-        addLog("SYSTEM: State recovered. Ver " + std::to_string(savedver));
-        updateLPS();
-    } catch (const std::exception& e) {
-        addLog("SYSTEM ERROR: Save data corrupted.");
+    if (earned > 0) {
+        addLog({.kind = LogKind::OFFLINE, .value = elapsed, .value2 = earned});
     }
-    
-    saveFile.close();
 }
 
 void Game::catchCache() {
     if (this->cacheOnScreen) {
         this->cacheOnScreen = false;
-        this->cacheSpawnTimer = 45.0 + (std::rand() % 45);
+        this->cacheSpawnTimer = 45.0 + rng.below(45);
         this->cacheBuffDurationTimer = CACHE_BUFF_DURATION;
         this->clickBoostPercent = CACHE_BUFF_PERCENT;
+        invalidateEconomy(ECON_CLICK);
         this->activeAlert = "BREACH PROTOCOL: 777x DATA MINING FOR 30s!";
         this->feedbackTimer = 2.0; 
-        addLog("SIGNAL: Anomalous intercept successful.");
+        addLog({.kind = LogKind::INTERCEPT});
     }
 }
 
-void Game::addLog(const std::string& msg) {
-    actionLog.push_front(msg);
-    if (actionLog.size() > EYE_CANDY_LOG_SIZE) {
-        actionLog.pop_back();
+void Game::addLog(const LogEntry& entry) {
+    actionLog.push(entry);
+}
+
+// Text for a log entry, written into buf; returns the snprintf length
+int Game::formatLog(const LogEntry& e, char* buf, size_t size, Utils::Notation notation) const {
+    const char* name = "?";
+    if (e.building >= 0 && e.building < (int)indexById.size() && indexById[e.building] >= 0) {
+        name = this->buildings.getName(indexById[e.building]).c_str();
+    }
+    char num[32], num2[32];
+
+    switch (e.kind) {
+        case LogKind::PURCHASED:
+            if (e.count == 1) return snprintf(buf, size, "SYSTEM: Purchased [%s]", name);
+            return snprintf(buf, size, "SYSTEM: Purchased %dx [%s]", e.count, name);
+        case LogKind::SOLD:
+            Utils::formatNumber(e.value, num, sizeof(num), notation);
+            return snprintf(buf, size, "SYSTEM: Sold %dx [%s] for %s DATA", e.count, name, num);
+        case LogKind::OVERCLOCK:
+            return snprintf(buf, size, "SYSTEM: Overclock updated to x%.2f", e.value.toDouble());
+        case LogKind::CLICK_SHARE:
+            return snprintf(buf, size, "SYSTEM: Click Share increased to %d%%", e.count);
+        case LogKind::PACKET:
+            Utils::formatNumber(e.value, num, sizeof(num), notation);
+            if (e.count > 1) return snprintf(buf, size, "PKT: [%08X] x%d captured (%s DATA)", e.packet, e.count, num);
+            return snprintf(buf, size, "PKT: [%08X] captured (%s DATA)", e.packet, num);
+        case LogKind::SAVED:
+            return snprintf(buf, size, "SYSTEM: Saved state.");
+        case LogKind::AUTOSAVED:
+            return snprintf(buf, size, "SYSTEM: Auto-save complete.");
+        case LogKind::RECOVERED:
+            return snprintf(buf, size, "SYSTEM: State recovered. Ver %d", e.count);
+        case LogKind::MIGRATED:
+            return snprintf(buf, size, "SYSTEM: Save migrated to Ver %d", e.count);
+        case LogKind::VERSION_MISMATCH:
+            return snprintf(buf, size, "SYSTEM RESET: Save data version mismatch! Reset to defaults.");
+        case LogKind::CORRUPT:
+            return snprintf(buf, size, "SYSTEM ERROR: Save data corrupted.");
+        case LogKind::OFFLINE:
+            Utils::formatNumber(e.value, num, sizeof(num), notation);
+            Utils::formatNumber(e.value2, num2, sizeof(num2), notation);
+            return snprintf(buf, size, "SYSTEM: Offline %ss, mined %s DATA", num, num2);
+        case LogKind::INTERCEPT:
+            return snprintf(buf, size, "SIGNAL: Anomalous intercept successful.");
     }
+    buf[0] = '\0';
+    return 0;
 }
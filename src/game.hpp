@@ -2,14 +2,37 @@
 
 #include <vector>
 #include <string>
-#include <deque>
+#include <memory>
 #include "building.hpp"
 #include "constants.hpp"
+#include "save_writer.hpp"
+#include "log_ring.hpp"
+#include "rng.hpp"
+#include "power_table.hpp"
+#include "utils.hpp"
+
+// Values derived from the purchase state, cached on Game
+struct Economy {
+    double rate;            // DATA per second, buffs included
+    BigNum buffCost;        // next Overclock
+    BigNum clickShareCost;  // next Breach share
+    double clickValue;      // DATA per breach
+};
+
+// What has to be recomputed; set by whatever changed the inputs
+enum EconomyDirty : uint8_t {
+    ECON_RATE = 1,          // linesPerSecond or buffs
+    ECON_BUFF_COST = 2,     // buffsBought
+    ECON_SHARE_COST = 4,    // clickSharesBought
+    ECON_CLICK = 8,         // rate, lpsToClick, baseClickAmt or clickBoostPercent
+    ECON_ALL = 15
+};
 
 class Game {
 public:
     double linesPerSecond;
-    double lines;
+    BigNum lines;       // grows past double's range; rates and click values don't
+    BigNum linesCarry;  // income credited but below lines' last bit; see credit()
     double buffs;
     double baseClickAmt;
     double lpsToClick;
@@ -26,25 +49,60 @@ public:
     double cacheBuffDurationTimer;
     bool cacheOnScreen;
     std::string activeAlert;
-    std::deque<std::string> actionLog;
+    LogRing actionLog;
+    uint64_t seed;
+    Rng rng;            // RNG_GAMEPLAY stream, saved with the game
+    Rng eyeCandyRng;    // RNG_EYE_CANDY stream
 
-    std::vector<Building> buildings;
+    BuildingTable buildings;
     int numBuildings;
 
-    Game(double lps, double b);
+    // seed 0 picks a random one; dataHome overrides $XDG_DATA_HOME for saves
+    Game(double lps, double b, uint64_t seed = 0, const std::string& dataHome = "");
 
+    // The catalog compiled into the binary
     void loadBuildings();
+    // Replace the catalog from a JSON file; false (catalog unchanged) if the
+    // file is missing or fails the same checks as the built-in one
+    bool loadBuildings(const std::string& path);
     void updateLPS();
-    void buyBuilding(int index);
-    double getBuffCost() const;
-    double getClickShareCost() const;
+    void buyBuilding(int index, int n = 1);
+    void sellBuilding(int index, int n = 1);
+    // Cached; only recomputed after a purchase, buff change, cache event or
+    // load has marked the values dirty
+    const Economy& economy() const;
+    // For code that writes the fields above directly
+    void invalidateEconomy(uint8_t flags = ECON_ALL) { this->economyDirty |= flags; }
+    BigNum getBuffCost() const { return economy().buffCost; }
+    BigNum getClickShareCost() const { return economy().clickShareCost; }
     void buyBuff();
     void buyClickShare();
     void runCycle(double deltat);
     void registerClick();
+    void registerClicks(int n);
     void updateTimers(double dt);
+    double nextTimerDeadline() const;
     void saveGame();
+    SaveSnapshot snapshot() const;
     void loadGame();
+    void applySnapshot(const SaveSnapshot& snap);
+    void applyOfflineProgress(double elapsed);
     void catchCache();
-    void addLog(const std::string& msg);
+    void addLog(const LogEntry& entry);
+    int formatLog(const LogEntry& entry, char* buf, size_t size,
+                  Utils::Notation notation = Utils::Notation::ENGINEERING) const;
+
+private:
+    std::unique_ptr<SaveWriter> saveWriter;
+    std::vector<int> indexById; // building id -> index in buildings, -1 if unused
+    mutable Economy cachedEconomy;
+    mutable uint8_t economyDirty = ECON_ALL;
+    PowerTable buffPowers{BUFF_COST_SCALE_FACTOR};
+    PowerTable sharePowers{LPS_TO_CLICK_COST_SCALE_FACTOR};
+
+    void indexBuildings();
+    // lines += amount, compensated: what rounding drops is kept in linesCarry
+    // and goes in with the next credit, so small ticks on a large total add up
+    // instead of vanishing
+    void credit(BigNum amount);
 };
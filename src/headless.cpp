@@ -0,0 +1,160 @@
+#include "headless.hpp"
+#include "game.hpp"
+#include "utils.hpp"
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+using Clock = std::chrono::steady_clock;
+using Duration = std::chrono::duration<double>;
+
+namespace {
+
+struct ScriptStep {
+    double at;
+    std::string action;
+    int index;
+    int amount;
+};
+
+// One step per line: "<sim seconds> <action> [index|count] [amount]".
+// Actions: click <count>, buy <index> <amount|max>, sell <index> <amount|max>,
+// buff, share, cache, save, load. '#' starts a comment.
+bool loadScript(const std::string& path, std::vector<ScriptStep>& steps) {
+    std::ifstream f(path);
+    if (!f.is_open()) return false;
+
+    std::string line;
+    while (std::getline(f, line)) {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream in(line);
+        ScriptStep step = {0, "", 1, 1};
+        if (!(in >> step.at >> step.action)) continue;
+
+        std::string arg;
+        if (in >> arg) step.index = std::atoi(arg.c_str());
+        if (in >> arg) step.amount = (arg == "max") ? BUY_MAX : std::atoi(arg.c_str());
+        if (step.action == "click") step.amount = step.index;
+        steps.push_back(step);
+    }
+    return true;
+}
+
+void applyStep(Game& game, const ScriptStep& step) {
+    if (step.action == "click") {
+        game.registerClicks(step.amount);
+    } else if (step.action == "buy") {
+        game.buyBuilding(step.index, step.amount);
+    } else if (step.action == "sell") {
+        game.sellBuilding(step.index, step.amount);
+    } else if (step.action == "buff") {
+        game.buyBuff();
+    } else if (step.action == "share") {
+        game.buyClickShare();
+    } else if (step.action == "cache") {
+        game.catchCache();
+    } else if (step.action == "save") {
+        game.saveGame();
+    } else if (step.action == "load") {
+        game.loadGame();
+    } else {
+        fprintf(stderr, "headless: unknown script action '%s'\n", step.action.c_str());
+    }
+}
+
+// The run proper, with its Game scoped so the save writer is joined before
+// runHeadless removes a scratch save directory
+int runGame(const HeadlessOptions& options, const std::vector<ScriptStep>& steps,
+            const std::string& saveDir, const std::atomic<bool>& keepRunning) {
+    Game game(0, 1.0, options.seed, saveDir);
+    game.actionLog.setCapacity(options.logLines);
+    if (!options.catalogPath.empty() && !game.loadBuildings(options.catalogPath)) {
+        fprintf(stderr, "headless: cannot load building catalog %s\n", options.catalogPath.c_str());
+        return 1;
+    }
+    game.loadGame();
+
+    // The tick count is fixed up front and simTime derived from it, so
+    // rounding in a running sum can't add a stray near-zero tick. Only the
+    // last tick is shortened, when seconds isn't a whole number of ticks.
+    double exactTicks = options.seconds / options.tick;
+    long long totalTicks = std::llround(exactTicks);
+    if (exactTicks - (double)totalTicks > 1e-9) totalTicks++;
+
+    size_t nextStep = 0;
+    long long ticks = 0;
+    double simTime = 0;
+    Clock::time_point start = Clock::now();
+
+    while (keepRunning && ticks < totalTicks) {
+        while (nextStep < steps.size() && steps[nextStep].at <= simTime) {
+            applyStep(game, steps[nextStep++]);
+        }
+
+        bool last = ticks + 1 == totalTicks;
+        double dt = last ? options.seconds - (double)ticks * options.tick : options.tick;
+        game.runCycle(dt);
+        game.updateTimers(dt);
+        ticks++;
+        simTime = last ? options.seconds : (double)ticks * options.tick;
+
+        if (options.realtime) {
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(Duration(simTime)));
+        }
+    }
+
+    // Steps at exactly --seconds come after the last tick
+    while (ticks == totalTicks && nextStep < steps.size() && steps[nextStep].at <= options.seconds) {
+        applyStep(game, steps[nextStep++]);
+    }
+
+    double wall = Duration(Clock::now() - start).count();
+    game.saveGame();
+
+    printf("ticks:          %lld\n", ticks);
+    printf("simulated:      %.3f s\n", simTime);
+    printf("wall:           %.6f s\n", wall);
+    printf("ticks/sec:      %.0f\n", wall > 0 ? ticks / wall : 0.0);
+    printf("speedup:        %.1fx\n", wall > 0 ? simTime / wall : 0.0);
+    printf("seed:           %llu\n", (unsigned long long)game.seed);
+    printf("lines:          %.6g (%s)\n", game.lines.toDouble(), Utils::formatNumber(game.lines, options.notation).c_str());
+    printf("lps:            %.6g\n", game.economy().rate);
+    printf("buffs:          %.2f (%d bought)\n", game.buffs, game.buffsBought);
+    printf("click share:    %.0f%% (%d bought)\n", game.lpsToClick * 100, game.clickSharesBought);
+    for (int i = 0; i < game.buildings.size(); i++) {
+        printf("  %-24s %d\n", game.buildings.getName(i).c_str(), game.buildings.getCount(i));
+    }
+    // A scratch directory is gone by the time anyone could look
+    if (!options.saveDir.empty()) printf("save dir:       %s\n", saveDir.c_str());
+    return 0;
+}
+
+}
+
+int runHeadless(const HeadlessOptions& options, const std::atomic<bool>& keepRunning) {
+    std::vector<ScriptStep> steps;
+    if (!options.scriptPath.empty() && !loadScript(options.scriptPath, steps)) {
+        fprintf(stderr, "headless: cannot read script %s\n", options.scriptPath.c_str());
+        return 1;
+    }
+
+    if (!options.saveDir.empty()) return runGame(options, steps, options.saveDir, keepRunning);
+
+    // Keep soak runs away from the player's real save
+    char tmpl[] = "/tmp/cybergrind-headless-XXXXXX";
+    if (!mkdtemp(tmpl)) {
+        fprintf(stderr, "headless: cannot create a save directory\n");
+        return 1;
+    }
+    int rc = runGame(options, steps, tmpl, keepRunning);
+    std::error_code ec;
+    std::filesystem::remove_all(tmpl, ec);
+    return rc;
+}
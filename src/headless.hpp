@@ -0,0 +1,23 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include "constants.hpp"
+#include "utils.hpp"
+
+struct HeadlessOptions {
+    double seconds = 60.0;          // simulated time to run for
+    double tick = 1.0 / 60.0;       // simulated seconds per tick
+    bool realtime = false;          // pace ticks against the wall clock
+    std::string scriptPath;         // optional scripted actions, see README
+    std::string saveDir;            // where saves go; a scratch temp dir if empty
+    int logLines = LOG_SCROLLBACK;  // log entries kept (--log-lines)
+    uint64_t seed = 0;              // PRNG seed for a new game; 0 picks one
+    std::string catalogPath;        // building catalog override; built-in if empty
+    Utils::Notation notation = Utils::Notation::ENGINEERING;  // for the final DATA
+};
+
+// Drives Game through the same runCycle/updateTimers loop as the UI, without
+// a terminal, and prints throughput and the final state on exit.
+int runHeadless(const HeadlessOptions& options, const std::atomic<bool>& keepRunning);
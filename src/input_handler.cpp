@@ -1,5 +1,31 @@
 #include "input_handler.hpp"
 #include <ncurses.h>
+#include <poll.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Kitty keyboard protocol event types
+const int KEY_EVENT_PRESS = 1;
+const int KEY_EVENT_RELEASE = 3;
+const int KEY_MOD_CTRL = 4;
+
+// Disambiguate escapes, report event types, report all keys as escape codes
+const char* const KEY_EVENTS_PUSH = "\x1b[>11u";
+const char* const KEY_EVENTS_POP = "\x1b[<u";
+// Protocol query followed by primary device attributes, which every terminal
+// answers; seeing the latter without the former means no support
+const char* const KEY_EVENTS_QUERY = "\x1b[?u\x1b[c";
+const int KEY_EVENTS_QUERY_TIMEOUT_MS = 300;
+// How long to wait for the rest of a key event split across reads (ssh, tmux)
+const int KEY_EVENT_SEQUENCE_TIMEOUT_MS = 50;
+
+}
 
 InputHandler::InputHandler() {
     // Basic Actions
@@ -16,14 +42,152 @@ InputHandler::InputHandler() {
     keyMap[KEY_DOWN] = GameAction::MOVE_DOWN;
     keyMap['\n'] = GameAction::BUY_SELECTED;
     keyMap[KEY_ENTER] = GameAction::BUY_SELECTED;
+    keyMap['r'] = GameAction::SELL_SELECTED;
+    keyMap['x'] = GameAction::CYCLE_BUY_AMOUNT;
+    keyMap['p'] = GameAction::TOGGLE_PERF;
+    keyMap[KEY_PPAGE] = GameAction::LOG_OLDER;
+    keyMap[KEY_NPAGE] = GameAction::LOG_NEWER;
+}
+
+Command InputHandler::handleInput(int ch) {
+    if (keyEvents && ch == 27) return readKeyEvent();
+    return lookup(ch);
 }
 
-Command InputHandler::handleInput(int ch) const {
+Command InputHandler::lookup(int ch) const {
     // Check general actions
     auto it = keyMap.find(ch);
     if (it != keyMap.end()) {
-        return {it->second, -1};
+        return {it->second};
+    }
+
+    return {GameAction::NONE};
+}
+
+bool InputHandler::enableKeyEvents() {
+    // putp goes through curses' terminfo output; flushed so the reply
+    // can't be waiting on our own buffer
+    putp(KEY_EVENTS_QUERY);
+    fflush(stdout);
+
+    // Scan replies for "ESC [ ? <flags> u" until the "ESC [ ? ... c" that
+    // answers the device attributes query. Anything else is a key typed
+    // meanwhile and goes back to curses once the replies are in.
+    int reply[64];
+    int len = 0;
+    std::vector<int> typed;
+    auto keepTyped = [&] {
+        typed.insert(typed.end(), reply, reply + len);
+        len = 0;
+    };
+    bool supported = false, answered = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(KEY_EVENTS_QUERY_TIMEOUT_MS);
+    while (!answered) {
+        int ch = getch();
+        if (ch == ERR) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0) break;
+            struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+            poll(&pfd, 1, (int)left);
+            continue;
+        }
+        if (ch == 27) keepTyped();
+        if (len == 0 && ch != 27) {
+            typed.push_back(ch);
+            continue;
+        }
+        reply[len++] = ch;
+        // Still a prefix of "ESC [ ?"?
+        if ((len == 2 && ch != '[') || (len == 3 && ch != '?')) {
+            keepTyped();
+            continue;
+        }
+        if (len > 3 && ch >= 0x40 && ch <= 0x7e) {
+            if (ch == 'u') supported = true;
+            if (ch == 'c') answered = true;
+            len = 0;
+        } else if (len == (int)(sizeof(reply) / sizeof(reply[0]))) {
+            keepTyped();
+        }
     }
+    keepTyped();
+    // ungetch puts a key in front of the queue, so the last one goes first
+    for (auto it = typed.rbegin(); it != typed.rend(); ++it) ungetch(*it);
 
-    return {GameAction::NONE, -1};
+    if (!supported) return false;
+    putp(KEY_EVENTS_PUSH);
+    fflush(stdout);
+    keyEvents = true;
+    return true;
+}
+
+void InputHandler::disableKeyEvents() {
+    if (!keyEvents) return;
+    putp(KEY_EVENTS_POP);
+    fflush(stdout);
+    keyEvents = false;
+}
+
+// Decodes "ESC [ code[:alternates] [; modifiers[:event]] final" after the ESC
+// has been read. Release and repeat events only matter for space.
+Command InputHandler::readKeyEvent() {
+    char seq[32];
+    int len = 0;
+    // Wait for the final byte rather than stopping at the first empty read,
+    // or the tail of a split sequence would come back as ordinary keys
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(KEY_EVENT_SEQUENCE_TIMEOUT_MS);
+    while (len < (int)sizeof(seq) - 1) {
+        int ch = getch();
+        if (ch == ERR) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0) break;
+            struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+            poll(&pfd, 1, (int)left);
+            continue;
+        }
+        seq[len++] = (char)ch;
+        if (len > 1 && ch >= 0x40 && ch <= 0x7e) break;
+    }
+    seq[len] = '\0';
+    // A lone ESC can still arrive, e.g. from a paste
+    if (len == 0) return {GameAction::QUIT};
+    if (len < 2 || seq[0] != '[') return {GameAction::NONE};
+
+    char final = seq[len - 1];
+    char* p = seq + 1;
+    int code = std::strtol(p, &p, 10);
+    while (*p == ':') std::strtol(p + 1, &p, 10);
+    int mods = 1;
+    int event = KEY_EVENT_PRESS;
+    if (*p == ';') {
+        mods = std::strtol(p + 1, &p, 10);
+        if (*p == ':') event = std::strtol(p + 1, &p, 10);
+    }
+    bool ctrl = mods > 1 && ((mods - 1) & KEY_MOD_CTRL);
+
+    int key = ERR;
+    switch (final) {
+        case 'u':
+            if (code == 13) key = '\n';
+            else if (code == 27) key = 27;
+            else if (ctrl && code == 'c') key = 'q'; // Ctrl+C no longer raises SIGINT
+            else if (code < 128) key = code;
+            break;
+        case 'A': key = KEY_UP; break;
+        case 'B': key = KEY_DOWN; break;
+        case '~':
+            if (code == 5) key = KEY_PPAGE;
+            else if (code == 6) key = KEY_NPAGE;
+            break;
+    }
+
+    if (key == ' ') {
+        if (event == KEY_EVENT_PRESS) return {GameAction::BREACH_PRESS};
+        if (event == KEY_EVENT_RELEASE) return {GameAction::BREACH_RELEASE};
+        return {GameAction::NONE};
+    }
+    if (event == KEY_EVENT_RELEASE || key == ERR) return {GameAction::NONE};
+    return lookup(key);
 }
@@ -5,6 +5,8 @@
 enum class GameAction {
     NONE,
     BREACH,
+    BREACH_PRESS,
+    BREACH_RELEASE,
     BUY_BUFF,
     BUY_CLICK_SHARE,
     SAVE,
@@ -14,19 +16,35 @@ enum class GameAction {
     MOVE_UP,
     MOVE_DOWN,
     BUY_SELECTED,
+    SELL_SELECTED,
+    CYCLE_BUY_AMOUNT,
+    TOGGLE_PERF,
+    LOG_OLDER,
+    LOG_NEWER,
     QUIT
 };
 
 struct Command {
     GameAction action;
-    int index; // Still useful if we want to pass context about a building
+    int index = -1;  // building for BUY_SELECTED/SELL_SELECTED, filled in by the caller
+    int amount = 1;  // how many to buy or sell
 };
 
 class InputHandler {
     public:
         InputHandler();
-        Command handleInput(int ch) const;
+        Command handleInput(int ch);
+
+        // Switch the terminal to the kitty keyboard protocol so key releases
+        // are reported; false (and nothing changed) if it isn't supported.
+        // In this mode space yields BREACH_PRESS/BREACH_RELEASE, not BREACH.
+        bool enableKeyEvents();
+        void disableKeyEvents();
 
     private:
         std::map<int, GameAction> keyMap;
+        bool keyEvents = false;
+
+        Command lookup(int ch) const;
+        Command readKeyEvent();
 };
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include "constants.hpp"
+#include "big_number.hpp"
+
+enum class LogKind : uint8_t {
+    PURCHASED,      // building, count
+    SOLD,           // building, count, value = refund
+    OVERCLOCK,      // value = new multiplier
+    CLICK_SHARE,    // count = percent
+    PACKET,         // packet, count = breaches, value = DATA captured
+    SAVED,
+    AUTOSAVED,
+    RECOVERED,      // count = save version
+    MIGRATED,       // count = save version
+    VERSION_MISMATCH,
+    CORRUPT,
+    OFFLINE,        // value = seconds away, value2 = DATA mined
+    INTERCEPT,
+};
+
+// One log event as data; turned into text only when it is actually displayed
+struct LogEntry {
+    LogKind kind;
+    int building = -1;      // building id
+    int count = 0;
+    uint32_t packet = 0;
+    BigNum value = 0;
+    BigNum value2 = 0;
+};
+
+// Fixed-capacity ring of log entries, newest first. Storage is allocated once
+// when the capacity is set, so pushing never allocates and the scrollback
+// never takes more than capacity() * sizeof(LogEntry) bytes.
+class LogRing {
+public:
+    explicit LogRing(int capacity = LOG_SCROLLBACK) { setCapacity(capacity); }
+
+    // Keeps the newest entries that still fit
+    void setCapacity(int capacity) {
+        capacity = std::clamp(capacity, EYE_CANDY_LOG_SIZE, MAX_LOG_SCROLLBACK);
+        std::vector<LogEntry> resized(capacity);
+        int keep = std::min(count, capacity);
+        for (int i = 0; i < keep; i++) resized[keep - 1 - i] = (*this)[i];
+        entries.swap(resized);
+        head = keep % capacity;
+        count = keep;
+    }
+
+    int capacity() const { return (int)entries.size(); }
+    int size() const { return count; }
+
+    // Entries ever pushed; changes whenever the visible log does
+    uint64_t pushed() const { return total; }
+
+    // 0 is the newest entry
+    const LogEntry& operator[](int i) const {
+        int cap = capacity();
+        return entries[(head - 1 - i + cap) % cap];
+    }
+
+    void push(const LogEntry& entry) {
+        entries[head] = entry;
+        head = (head + 1) % capacity();
+        if (count < capacity()) count++;
+        total++;
+    }
+
+private:
+    std::vector<LogEntry> entries;
+    int head = 0;
+    int count = 0;
+    uint64_t total = 0;
+};
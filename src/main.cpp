@@ -1,15 +1,32 @@
 #include <atomic>
 #include <csignal>
 #include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <poll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <clocale>
 #include <thread>
 #include "game.hpp"
+#include "headless.hpp"
 #include "renderer.hpp"
 #include "input_handler.hpp"
+#include "perf_stats.hpp"
+#include "trace.hpp"
+#include "session.hpp"
+#include "banners.hpp"
 
-using Clock = std::chrono::high_resolution_clock;
+using Clock = std::chrono::steady_clock;
 using TimePoint = std::chrono::time_point<Clock>;
 using Duration = std::chrono::duration<double>;
 
+namespace {
+
+// Only the signal handler needs this at file scope; the engine just gets a reference
 std::atomic<bool> keep_running{true};
 
 void handle_sigint(int signal) {
@@ -17,78 +34,298 @@ void handle_sigint(int signal) {
     keep_running = false;
 }
 
-int main() {
-    std::signal(SIGINT, handle_sigint);
+void print_usage(const char* prog) {
+    printf("usage: %s [--log-lines N] [--hold-breach] [--seed N] [--catalog FILE] [--notation eng|sci] [--startup-trace] [--record FILE] [--replay FILE] [--headless [--seconds N] [--tick DT] [--realtime] [--script FILE] [--save-dir DIR]]\n", prog);
+}
+
+double ms(TimePoint from, TimePoint to) {
+    return Duration(to - from).count() * 1e3;
+}
+
+// Launch latency for --startup-trace. Reported on destruction, so declare it
+// before the Renderer and it prints once the terminal has been restored.
+struct StartupTrace {
+    bool enabled = false;
+    TimePoint launch;
+    TimePoint loadStart, loadDone;      // on the loader thread
+    TimePoint terminalReady, bannerRead;
+    TimePoint firstPaint, splashDismissed;
+    TimePoint interactive;              // first game frame on the terminal
+
+    ~StartupTrace() {
+        if (!enabled || interactive == TimePoint()) return;
+        // Time spent looking at the splash is the user's, not ours
+        Duration splashWait = splashDismissed - firstPaint;
+        fprintf(stderr, "startup: first paint     %8.3f ms\n", ms(launch, firstPaint));
+        fprintf(stderr, "startup: interactive     %8.3f ms (excluding %.1f ms on the splash)\n",
+                ms(launch, interactive) - splashWait.count() * 1e3, splashWait.count() * 1e3);
+        fprintf(stderr, "  terminal init          %8.3f ms\n", ms(launch, terminalReady));
+        fprintf(stderr, "  banner read            %8.3f ms\n", ms(terminalReady, bannerRead));
+        fprintf(stderr, "  save load (overlapped) %8.3f ms, done at %.3f ms\n",
+                ms(loadStart, loadDone), ms(launch, loadDone));
+    }
+};
+
+struct InteractiveOptions {
+    int logLines;
+    bool holdBreach;
+    uint64_t seed;
+    std::string catalogPath;
+    std::string recordPath;
+    Utils::Notation notation;
+};
+
+// The terminal game. Game and its save writer live and die in here, so they
+// are gone before main shuts tracing down.
+int runInteractive(const InteractiveOptions& options, StartupTrace& startup) {
+    Game game(0, 1.0, options.seed);
+    game.actionLog.setCapacity(options.logLines);
+    if (!options.catalogPath.empty() && !game.loadBuildings(options.catalogPath)) {
+        fprintf(stderr, "cannot load building catalog %s\n", options.catalogPath.c_str());
+        return 1;
+    }
+
+    // Starts before the initial load so a replay can rebuild the same Game
+    SessionRecorder recorder;
+    if (!options.recordPath.empty() && !recorder.open(options.recordPath, game.seed)) {
+        fprintf(stderr, "cannot write session log %s\n", options.recordPath.c_str());
+        return 1;
+    }
+    CommandDispatcher dispatcher(game, &recorder);
 
-    Game game(0, 1.0);
-    game.loadGame();
+    // Armed for the next pending deadline so the loop can sleep in poll()
+    // instead of waking every frame
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+
+    // The save and the splash banner are independent, so the save is read on
+    // a worker while the terminal comes up. The worker owns game until the
+    // join; the banner draws from a copy of the cosmetic stream. Process-wide
+    // state the load touches, like the locale, is settled in main beforehand.
+    Rng bannerRng = game.eyeCandyRng;
+    std::thread loader([&game, &startup] {
+        startup.loadStart = Clock::now();
+        game.loadGame();
+        startup.loadDone = Clock::now();
+    });
 
     Renderer renderer;
     InputHandler inputHandler;
+    PerfStats perf;
+    renderer.attachPerfStats(&perf);
+    renderer.setNotation(options.notation);
+    startup.terminalReady = Clock::now();
+
+    std::vector<std::string> banner = loadSplashBanner(bannerRng);
+    startup.bannerRead = Clock::now();
 
     // Display splash screen and wait for input
-    renderer.drawSplashScreen();
+    startup.firstPaint = renderer.drawSplashScreen(banner);
+    startup.splashDismissed = Clock::now();
+
+    loader.join();
+    recorder.snapshot(game);
+
+    // Show the game right away rather than after the loop's first wait
+    renderer.render(game);
+    startup.interactive = Clock::now();
+
+    // Without key release events, holding space just autorepeats as before
+    if (options.holdBreach) inputHandler.enableKeyEvents();
+    TimePoint holdStart;
+    long long holdTicks = 0;
 
     TimePoint lasttime = Clock::now();
 
     while (keep_running) {
-        int ch;
-        while ((ch = getch()) != ERR) {
-            Command cmd = inputHandler.handleInput(ch);
-            
-            switch (cmd.action) {
-                case GameAction::QUIT:
-                    keep_running = false;
-                    break;
-                case GameAction::BREACH:
-                    game.registerClick();
-                    break;
-                case GameAction::BUY_BUFF:
-                    game.buyBuff();
-                    break;
-                case GameAction::BUY_CLICK_SHARE:
-                    game.buyClickShare();
-                    break;
-                case GameAction::SAVE:
-                    game.saveGame();
-                    break;
-                case GameAction::LOAD:
-                    game.loadGame();
-                    break;
-                case GameAction::CATCH_CACHE:
-                    game.catchCache();
-                    break;
-                case GameAction::RESIZE:
-                    renderer.handleResize();
-                    break;
-                case GameAction::MOVE_UP:
-                    renderer.moveSelection(-1, game.buildings.size());
-                    break;
-                case GameAction::MOVE_DOWN:
-                    renderer.moveSelection(1, game.buildings.size());
-                    break;
-                case GameAction::BUY_SELECTED:
-                    game.buyBuilding(renderer.getSelectedIndex());
-                    break;
-                case GameAction::NONE:
-                default:
-                    break;
+        double wait = std::min(game.nextTimerDeadline(), renderer.nextRedrawIn(game));
+        if (dispatcher.breachHeld()) {
+            double nextTick = (holdTicks + 1) / HOLD_BREACH_RATE;
+            wait = std::min(wait, nextTick - Duration(Clock::now() - holdStart).count());
+        }
+        wait = std::clamp(wait, MIN_FRAME_INTERVAL, MAX_IDLE_WAIT);
+
+        struct pollfd fds[2] = {
+            {STDIN_FILENO, POLLIN, 0},
+            {timer_fd, POLLIN, 0},
+        };
+        if (timer_fd >= 0) {
+            struct itimerspec spec = {};
+            spec.it_value.tv_sec = (time_t)wait;
+            spec.it_value.tv_nsec = (long)((wait - (double)spec.it_value.tv_sec) * 1e9);
+            timerfd_settime(timer_fd, 0, &spec, nullptr);
+            poll(fds, 2, -1);
+        } else {
+            poll(fds, 1, (int)(wait * 1000));
+        }
+        // EINTR (SIGINT, SIGWINCH) just falls through to a normal frame
+        if (timer_fd >= 0 && (fds[1].revents & POLLIN)) {
+            uint64_t expirations;
+            (void)!read(timer_fd, &expirations, sizeof(expirations));
+        }
+        TimePoint wake = Clock::now();
+        perf.countWakeup();
+
+        {
+            TRACE_SCOPE("input");
+            // Autorepeat floods in as individual BREACH events; the
+            // dispatcher credits them together, before any other action that
+            // may spend them
+            int ch;
+            while ((ch = getch()) != ERR) {
+                Command cmd = inputHandler.handleInput(ch);
+                if (cmd.action == GameAction::BUY_SELECTED || cmd.action == GameAction::SELL_SELECTED) {
+                    cmd.index = renderer.getSelectedIndex();
+                    cmd.amount = renderer.getBuyAmount();
+                }
+                if (cmd.action == GameAction::BREACH_PRESS && !dispatcher.breachHeld()) {
+                    holdStart = Clock::now();
+                    holdTicks = 0;
+                }
+                dispatcher.apply(cmd);
+
+                // UI side; the game side went through the dispatcher
+                switch (cmd.action) {
+                    case GameAction::QUIT:
+                        keep_running = false;
+                        break;
+                    case GameAction::RESIZE:
+                        renderer.handleResize();
+                        break;
+                    case GameAction::MOVE_UP:
+                        renderer.moveSelection(-1, game.buildings.size());
+                        break;
+                    case GameAction::MOVE_DOWN:
+                        renderer.moveSelection(1, game.buildings.size());
+                        break;
+                    case GameAction::CYCLE_BUY_AMOUNT:
+                        renderer.cycleBuyAmount();
+                        break;
+                    case GameAction::TOGGLE_PERF:
+                        renderer.togglePerfOverlay();
+                        break;
+                    case GameAction::LOG_OLDER:
+                        renderer.scrollLog(1);
+                        break;
+                    case GameAction::LOG_NEWER:
+                        renderer.scrollLog(-1);
+                        break;
+                    case GameAction::NONE:
+                    default:
+                        break;
+                }
             }
+            dispatcher.flush();
         }
 
         TimePoint curtime = Clock::now();
         Duration delta_time = curtime - lasttime;
         lasttime = curtime;
 
-        game.runCycle(delta_time.count());
-        game.updateTimers(delta_time.count());
+        // Held breach runs at a fixed rate, independent of keyboard repeat
+        if (dispatcher.breachHeld()) {
+            long long due = (long long)(Duration(curtime - holdStart).count() * HOLD_BREACH_RATE);
+            dispatcher.hold((int)(due - holdTicks));
+            holdTicks = due;
+        }
+
+        dispatcher.frame(delta_time.count());
+        TimePoint simulated = Clock::now();
 
         renderer.render(game);
+        TimePoint rendered = Clock::now();
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(16)); 
+        double flush = renderer.getLastFlushTime();
+        perf.recordFrame(Duration(simulated - wake).count(),
+                         Duration(rendered - simulated).count() - flush, flush);
+        perf.update(rendered);
     }
 
+    if (timer_fd >= 0) close(timer_fd);
+    inputHandler.disableKeyEvents();
+    recorder.finish(game);
     game.saveGame();
-
     return 0;
 }
+}
+
+int main(int argc, char** argv) {
+    StartupTrace startup;
+    startup.launch = Clock::now();
+    std::signal(SIGINT, handle_sigint);
+    // Process-wide and not thread-safe, so set before the save loader thread
+    // starts parsing numbers; ncurses reads it when the Renderer comes up
+    std::setlocale(LC_ALL, "");
+
+    bool headless = false;
+    HeadlessOptions headlessOptions;
+    int logLines = LOG_SCROLLBACK;
+    bool holdBreach = false;
+    uint64_t seed = 0;
+    std::string recordPath;
+    std::string catalogPath;
+    std::string replayPath;
+    Utils::Notation notation = Utils::Notation::ENGINEERING;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--headless") == 0) {
+            headless = true;
+        } else if (std::strcmp(arg, "--hold-breach") == 0) {
+            holdBreach = true;
+        } else if (std::strcmp(arg, "--startup-trace") == 0) {
+            startup.enabled = true;
+        } else if (std::strcmp(arg, "--realtime") == 0) {
+            headlessOptions.realtime = true;
+        } else if (std::strcmp(arg, "--seconds") == 0 && hasValue) {
+            headlessOptions.seconds = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--tick") == 0 && hasValue) {
+            headlessOptions.tick = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--script") == 0 && hasValue) {
+            headlessOptions.scriptPath = argv[++i];
+        } else if (std::strcmp(arg, "--save-dir") == 0 && hasValue) {
+            headlessOptions.saveDir = argv[++i];
+        } else if (std::strcmp(arg, "--catalog") == 0 && hasValue) {
+            catalogPath = argv[++i];
+        } else if (std::strcmp(arg, "--notation") == 0 && hasValue &&
+                   (std::strcmp(argv[i + 1], "eng") == 0 || std::strcmp(argv[i + 1], "sci") == 0)) {
+            notation = std::strcmp(argv[++i], "sci") == 0 ? Utils::Notation::SCIENTIFIC
+                                                          : Utils::Notation::ENGINEERING;
+        } else if (std::strcmp(arg, "--record") == 0 && hasValue) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(arg, "--replay") == 0 && hasValue) {
+            replayPath = argv[++i];
+        } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--log-lines") == 0 && hasValue) {
+            logLines = std::atoi(argv[++i]);
+        } else {
+            print_usage(argv[0]);
+            return std::strcmp(arg, "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (!replayPath.empty()) {
+        return runReplay(replayPath, catalogPath, keep_running);
+    }
+
+    if (headless) {
+        if (headlessOptions.tick <= 0) {
+            fprintf(stderr, "--tick must be positive\n");
+            return 1;
+        }
+        headlessOptions.logLines = logLines;
+        headlessOptions.seed = seed;
+        headlessOptions.catalogPath = catalogPath;
+        headlessOptions.notation = notation;
+        TRACE_INIT();
+        int rc = runHeadless(headlessOptions, keep_running);
+        TRACE_SHUTDOWN();
+        return rc;
+    }
+
+    InteractiveOptions options = {logLines, holdBreach, seed, catalogPath, recordPath, notation};
+    TRACE_INIT();
+    int rc = runInteractive(options, startup);
+    TRACE_SHUTDOWN();
+    return rc;
+}
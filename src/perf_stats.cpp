@@ -0,0 +1,77 @@
+#include "perf_stats.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+namespace {
+
+double processCpuSeconds() {
+    rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+// Bytes passed to write() and friends by any thread, whatever the fd. ncurses
+// writes straight to the terminal's fd, so its share can't be split out here;
+// bench_render counts terminal bytes exactly.
+uint64_t processWriteBytes() {
+    int fd = open("/proc/self/io", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    char buf[512];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return 0;
+    buf[n] = '\0';
+    const char* wchar = std::strstr(buf, "wchar:");
+    return wchar ? std::strtoull(wchar + 6, nullptr, 10) : 0;
+}
+
+}
+
+PerfStats::PerfStats()
+    : windowStart(Clock::now()), lastCpuSeconds(processCpuSeconds()),
+      lastProcessBytes(processWriteBytes()) {}
+
+void PerfStats::recordFrame(double sim, double render, double flush) {
+    ring[head] = {(float)sim, (float)render, (float)flush};
+    head = (head + 1) % CAPACITY;
+    if (count < CAPACITY) count++;
+}
+
+void PerfStats::update(Clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - windowStart).count();
+    if (elapsed < 1.0) return;
+
+    double cpu = processCpuSeconds();
+    uint64_t bytes = processWriteBytes();
+    current.cpuPercent = (cpu - lastCpuSeconds) / elapsed * 100.0;
+    current.processBytesPerSec = (bytes - lastProcessBytes) / elapsed;
+    current.wakeupsPerSec = wakeups / elapsed;
+    lastCpuSeconds = cpu;
+    lastProcessBytes = bytes;
+    wakeups = 0;
+    windowStart = now;
+
+    if (count == 0) return;
+    float totals[CAPACITY];
+    double sim = 0, render = 0, flush = 0;
+    for (int i = 0; i < count; i++) {
+        totals[i] = ring[i].sim + ring[i].render + ring[i].flush;
+        sim += ring[i].sim;
+        render += ring[i].render;
+        flush += ring[i].flush;
+    }
+    current.simAvg = sim / count;
+    current.renderAvg = render / count;
+    current.flushAvg = flush / count;
+
+    int p50 = count / 2;
+    int p99 = std::min(count - 1, count * 99 / 100);
+    std::nth_element(totals, totals + p50, totals + count);
+    current.frameP50 = totals[p50];
+    std::nth_element(totals, totals + p99, totals + count);
+    current.frameP99 = totals[p99];
+}
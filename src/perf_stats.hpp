@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Per-frame timings kept in a fixed ring, plus process-level counters that are
+// sampled once per second. Recording a frame is a few stores; the summary the
+// overlay reads is only recomputed when the one-second window rolls over.
+class PerfStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static const int CAPACITY = 256;
+
+    struct Summary {
+        double frameP50;       // seconds of work per frame
+        double frameP99;
+        double simAvg;         // input handling + runCycle + updateTimers
+        double renderAvg;      // composing windows
+        double flushAvg;       // doupdate, i.e. writing to the terminal
+        double wakeupsPerSec;
+        double cpuPercent;
+        // Every write the process made (terminal, saves, trace output), from
+        // wchar in /proc/self/io; not terminal output alone
+        double processBytesPerSec;
+    };
+
+    PerfStats();
+
+    void countWakeup() { wakeups++; }
+    void recordFrame(double sim, double render, double flush);
+    // Roll the one-second window if it has elapsed
+    void update(Clock::time_point now);
+
+    const Summary& summary() const { return current; }
+
+private:
+    struct FrameSample {
+        float sim;
+        float render;
+        float flush;
+    };
+
+    FrameSample ring[CAPACITY];
+    int head = 0;
+    int count = 0;
+    uint32_t wakeups = 0;
+
+    Clock::time_point windowStart;
+    double lastCpuSeconds;
+    uint64_t lastProcessBytes;
+    Summary current = {};
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "big_number.hpp"
+
+// base^n for whole n, filled in with BigNum::pow the first time each n is
+// asked for and looked up after that, so the results are bit-identical to
+// calling it directly. Grows in doubling steps up to MAX_ENTRIES; anything
+// past that (or negative) falls through to pow. Owned by whoever uses it,
+// so engines on different threads never share one.
+class PowerTable {
+public:
+    explicit PowerTable(double base) : base(base) {}
+
+    BigNum operator()(int n) const {
+        if (n >= 0 && n < (int)powers.size()) return powers[n];
+        return extend(n);
+    }
+
+private:
+    static constexpr int MAX_ENTRIES = 1 << 16;
+
+    double base;
+    mutable std::vector<BigNum> powers;
+
+    BigNum extend(int n) const {
+        if (n < 0 || n >= MAX_ENTRIES) return BigNum::pow(base, n);
+        int size = std::min(MAX_ENTRIES, std::max({n + 1, 2 * (int)powers.size(), 64}));
+        powers.reserve(size);
+        for (int k = (int)powers.size(); k < size; k++) powers.push_back(BigNum::pow(base, k));
+        return powers[n];
+    }
+};
@@ -1,17 +1,30 @@
 #include "renderer.hpp"
 #include "utils.hpp"
-#include "json.hpp"
-#include <fstream>
-#include <clocale>
+#include "trace.hpp"
 #include <cstdlib>
-#include <ctime>
-
-using json = nlohmann::json;
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+// Dynamic fields tracked by the header and stats view models
+enum HeaderSlot { SLOT_FRAME, SLOT_CPU, SLOT_SAVED, SLOT_SIGNAL, HEADER_SLOTS };
+enum PerfSlot { SLOT_PERF_FRAME, SLOT_PERF_PHASES, SLOT_PERF_WAKEUPS, SLOT_PERF_CPU, SLOT_PERF_BYTES, PERF_SLOTS };
+
+const int PERF_OVERLAY_HEIGHT = 7;
+const int PERF_OVERLAY_WIDTH = 46;
+enum StatsSlot {
+    SLOT_BANK, SLOT_RATE, SLOT_ALERT, SLOT_BUFF, SLOT_BUFF_COST, SLOT_SHARE, SLOT_SHARE_COST,
+    SLOT_LOG_SCROLL, SLOT_LOG, STATS_SLOTS = SLOT_LOG + EYE_CANDY_LOG_SIZE
+};
+}
 
-Renderer::Renderer() {
-    std::setlocale(LC_ALL, "");
-    std::srand(std::time(nullptr));
-    initscr();
+// Expects the caller to have set the locale already (ncurses needs it for
+// wide characters)
+Renderer::Renderer(SCREEN* screen) {
+    // An explicit screen (from newterm) lets benchmarks render to a pipe
+    if (screen) set_term(screen);
+    else initscr();
     start_color();
     use_default_colors();
     init_pair(1, COLOR_GREEN, -1);
@@ -25,65 +38,13 @@ Renderer::Renderer() {
 
     getmaxyx(stdscr, maxY, maxX);
 
-    // Load assets from banners.txt
-    std::string bannersPath = Utils::getDataPath("banners.txt");
-    std::ifstream bf(bannersPath);
-    std::vector<std::vector<std::string>> allBanners;
-    if (bf.is_open()) {
-        std::string line;
-        std::vector<std::string> currentBanner;
-        while (std::getline(bf, line)) {
-            // Trim potential \r from Windows-style line endings
-            if (!line.empty() && line.back() == '\r') line.pop_back();
-            
-            if (line == "@@@") {
-                if (!currentBanner.empty()) {
-                    allBanners.push_back(currentBanner);
-                    currentBanner.clear();
-                }
-            } else {
-                currentBanner.push_back(line);
-            }
-        }
-        if (!currentBanner.empty()) allBanners.push_back(currentBanner);
-        
-        if (!allBanners.empty()) {
-            int index = std::rand() % (int)allBanners.size();
-            splashBanner = allBanners[index];
-        }
-    }
-
-    // Fallback to assets.json if banners.txt was empty or missing
-    if (splashBanner.empty()) {
-        std::string assetPath = Utils::getDataPath("assets.json");
-        std::ifstream f(assetPath);
-        if (f.is_open()) {
-            try {
-                json data = json::parse(f);
-                if (data.contains("splash_banners") && data["splash_banners"].is_array()) {
-                    auto& banners = data["splash_banners"];
-                    if (!banners.empty()) {
-                        int index = std::rand() % (int)banners.size();
-                        auto& chosen = banners[index];
-                        for (const auto& line : chosen) {
-                            splashBanner.push_back(line.get<std::string>());
-                        }
-                    }
-                } else if (data.contains("splash_banner") && data["splash_banner"].is_array()) {
-                    for (const auto& line : data["splash_banner"]) {
-                        splashBanner.push_back(line.get<std::string>());
-                    }
-                }
-            } catch (...) { /* ignore */ }
-        }
-    }
-
     header_win = std::make_unique<Window>(3, maxX, 0, 0);
     stats_win  = std::make_unique<Window>(maxY - 3, maxX / 2, 3, 0);
     shop_win   = std::make_unique<Window>(maxY - 3, maxX - (maxX / 2), 3, maxX / 2);
 }
 
-void Renderer::drawSplashScreen() {
+std::chrono::steady_clock::time_point Renderer::drawSplashScreen(const std::vector<std::string>& splashBanner) {
+    std::chrono::steady_clock::time_point firstPaint;
     bool waiting = true;
     nodelay(stdscr, FALSE);
     
@@ -114,6 +75,7 @@ void Renderer::drawSplashScreen() {
         attroff(A_BLINK | A_BOLD);
         
         refresh();
+        if (firstPaint == std::chrono::steady_clock::time_point()) firstPaint = std::chrono::steady_clock::now();
 
         int ch = getch();
         if (ch != KEY_RESIZE) {
@@ -125,6 +87,7 @@ void Renderer::drawSplashScreen() {
     }
     
     nodelay(stdscr, TRUE);
+    return firstPaint;
 }
 
 Renderer::~Renderer() {
@@ -132,6 +95,7 @@ Renderer::~Renderer() {
     header_win.reset();
     stats_win.reset();
     shop_win.reset();
+    perf_win.reset();
     endwin();
 }
 
@@ -142,12 +106,96 @@ void Renderer::handleResize() {
     stats_win->resize(maxY - 3, maxX / 2, 3, 0);
     shop_win->resize(maxY - 3, maxX - (maxX / 2), 3, maxX / 2);
 
-    // Clear stdscr to fix ghosting on resize
+    // Clear stdscr to fix ghosting on resize; the wipe goes out with the
+    // next frame's doupdate rather than as a write of its own
     clear();
-    refresh();
+    wnoutrefresh(stdscr);
+    if (perf_win) placePerfOverlay();
+    layoutDirty = true;
 }
 
 void Renderer::render(const Game& game) {
+    TRACE_SCOPE("Renderer::render");
+    // Windows are only wiped when the layout changes; after that every
+    // dynamic field is repainted only when its text or attributes change.
+    if (layoutDirty) {
+        drawChrome();
+        header_view.reset(HEADER_SLOTS);
+        stats_view.reset(STATS_SLOTS);
+        logDrawnScroll = -1;
+        shop_view.reset(0);
+        perf_view.reset(PERF_SLOTS);
+        lastCpuLoad = -1;
+        if (perf_win) {
+            perf_win->clear();
+            perf_win->drawBox();
+            WINDOW* pw = perf_win->get();
+            wattron(pw, COLOR_PAIR(3) | A_BOLD);
+            mvwprintw(pw, 0, 2, " [ PERF ] ");
+            wattroff(pw, COLOR_PAIR(3) | A_BOLD);
+        }
+        layoutDirty = false;
+    }
+
+    drawHeader(game);
+    drawStats(game);
+    drawShop(game);
+    if (perf_win) drawPerfOverlay();
+
+    // One doupdate for all windows, so a frame is a single write burst
+    header_win->stage();
+    stats_win->stage();
+    shop_win->stage();
+    if (perf_win) {
+        // Sits on top of the stats pane; recopy it whole so nothing underneath shows through
+        touchwin(perf_win->get());
+        perf_win->stage();
+    }
+    auto flushStart = std::chrono::steady_clock::now();
+    {
+        TRACE_SCOPE("doupdate");
+        doupdate();
+    }
+    lastFlushTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - flushStart).count();
+}
+
+void Renderer::togglePerfOverlay() {
+    if (perf_win) perf_win.reset();
+    else placePerfOverlay();
+    // Full repaint either way: the overlay's chrome, or what it was covering
+    layoutDirty = true;
+}
+
+// Bottom of the stats pane, above its border
+void Renderer::placePerfOverlay() {
+    int w = std::min(PERF_OVERLAY_WIDTH, maxX / 2 - 2);
+    int y = std::max(3, maxY - PERF_OVERLAY_HEIGHT - 1);
+    perf_win = std::make_unique<Window>(PERF_OVERLAY_HEIGHT, std::max(w, 10), y, 1);
+}
+
+void Renderer::drawPerfOverlay() {
+    WINDOW* win = perf_win->get();
+    PerfStats::Summary s = perf ? perf->summary() : PerfStats::Summary{};
+    char buf[128];
+
+    snprintf(buf, sizeof(buf), "frame  p50 %6.3fms  p99 %6.3fms", s.frameP50 * 1e3, s.frameP99 * 1e3);
+    perf_view.paint(win, SLOT_PERF_FRAME, 1, 2, A_NORMAL, buf);
+    snprintf(buf, sizeof(buf), "sim %.3f  render %.3f  flush %.3f ms",
+             s.simAvg * 1e3, s.renderAvg * 1e3, s.flushAvg * 1e3);
+    perf_view.paint(win, SLOT_PERF_PHASES, 2, 2, A_NORMAL, buf);
+    snprintf(buf, sizeof(buf), "wakeups/s  %.1f", s.wakeupsPerSec);
+    perf_view.paint(win, SLOT_PERF_WAKEUPS, 3, 2, A_NORMAL, buf);
+    snprintf(buf, sizeof(buf), "cpu        %.2f%%", s.cpuPercent);
+    perf_view.paint(win, SLOT_PERF_CPU, 4, 2, A_NORMAL, buf);
+    char num[32];
+    Utils::formatNumber(s.processBytesPerSec, num, sizeof(num));
+    snprintf(buf, sizeof(buf), "proc wr/s  %s B", num);
+    perf_view.paint(win, SLOT_PERF_BYTES, 5, 2, A_NORMAL, buf);
+}
+
+// Borders, titles and labels that never change; drawn once per layout and
+// left in place underneath the dynamic fields.
+void Renderer::drawChrome() {
     header_win->clear();
     stats_win->clear();
     shop_win->clear();
@@ -156,162 +204,268 @@ void Renderer::render(const Game& game) {
     stats_win->drawBox();
     shop_win->drawBox();
 
-    drawHeader(game);
-    drawStats(game);
-    drawShop(game);
-
-    header_win->refresh();
-    stats_win->refresh();
-    shop_win->refresh();
-}
-
-void Renderer::drawHeader(const Game& game) {
     WINDOW* win = header_win->get();
     wattron(win, COLOR_PAIR(3) | A_BOLD);
     mvwprintw(win, 0, 2, " [ SYSTEM STATUS ] ");
     wattroff(win, COLOR_PAIR(3) | A_BOLD);
-
-    // Decorative Metadata
     mvwprintw(win, 1, 2, "CONN: APOGEE_NODE_6");
-    mvwprintw(win, 1, 25, "LATENCY: %.1lfms", game.lastdeltat * 1000);
-    
-    // CPU Load Bar
     mvwprintw(win, 1, 45, "CPU: [");
-    int load = (int)(game.linesPerSecond > 0 ? 4 : 1) + (std::rand() % 3);
-    if (game.feedbackTimer > 0) load = 9 + (std::rand() % 3); // Spike on click
-    for (int i = 0; i < 15; i++) {
-        if (i < load) waddch(win, '|' | COLOR_PAIR(1));
-        else waddch(win, '.' | A_DIM);
-    }
-    waddch(win, ']');
 
-    if (game.feedbackTimer > 0) {
-        wattron(win, A_BOLD);
-        // uncomment for more click feedback
-        // mvwprintw(win, 2, 2, "+++ BREACHED FOR: %s DATA +++", Utils::formatNumber(game.lastClickValue).c_str());
-        wattroff(win, A_BOLD);
-    }
-    if (game.autosaveFeedbackTimer > 0) {
-        wattron(win, COLOR_PAIR(1) | A_BOLD);
-        mvwprintw(win, 1, maxX - 30, "[ SYSTEM: PROGRESS SAVED ]");
-        wattroff(win, COLOR_PAIR(1) | A_BOLD);
+    win = stats_win->get();
+    wattron(win, COLOR_PAIR(3) | A_BOLD);
+    mvwprintw(win, 0, 2, " [ TERMINAL ] ");
+    wattroff(win, COLOR_PAIR(3) | A_BOLD);
+    mvwprintw(win, 2, 2, "TARGET: Blackwall");
+    wattron(win, A_REVERSE);
+    mvwprintw(win, 3, 2, " PRESS SPACE TO BREACH ");
+    wattroff(win, A_REVERSE);
+    wattron(win, A_DIM | A_BOLD);
+    mvwprintw(win, 15, 2, "--- LOG_STREAM_INITIALIZED ---");
+    wattroff(win, A_DIM | A_BOLD);
+
+    win = shop_win->get();
+    wattron(win, COLOR_PAIR(3) | A_BOLD);
+    mvwprintw(win, 0, 2, " [ BLACK MARKET ] ");
+    wattroff(win, COLOR_PAIR(3) | A_BOLD);
+    wattron(win, A_BOLD);
+    mvwprintw(win, 2, 2, "QUICKHACKS");
+    mvwprintw(win, 3, 2, "------------------------------------------");
+    wattroff(win, A_BOLD);
+}
+
+// Seconds until something on screen would look different without any input:
+// the DATA counters ticking over their last printed digit, a cost becoming
+// affordable, or the buff countdown moving to the next tenth.
+double Renderer::nextRedrawIn(const Game& game) const {
+    double next = MAX_IDLE_WAIT;
+    auto consider = [&next](double t) {
+        if (t > 0 && t < next) next = t;
+    };
+
+    if (game.cacheBuffDurationTimer > 0) consider(0.1);
+
+    const Economy& econ = game.economy();
+    double rate = econ.rate;
+    if (rate > 0) {
+        consider((Utils::formatStep(game.lines, notation) / rate).toDouble());
+        consider(((econ.buffCost - game.lines) / rate).toDouble());
+        consider(((econ.clickShareCost - game.lines) / rate).toDouble());
+        consider(((game.buildings.cheapestAbove(buyAmount, game.lines) - game.lines) / rate).toDouble());
     }
+    return next;
+}
 
-    if (game.cacheOnScreen) {
-        wattron(win, COLOR_PAIR(3) | A_BLINK | A_BOLD);
-        mvwprintw(win, 2, maxX - 65, " [!] ANOMALOUS SIGNAL DETECTED - PRESS 'g' TO INTERCEPT [!] ");
-        wattroff(win, COLOR_PAIR(3) | A_BLINK | A_BOLD);
+void Renderer::drawHeader(const Game& game) {
+    WINDOW* win = header_win->get();
+    char buf[128];
+
+    // Measured frame cost and process CPU; 'p' opens the full breakdown
+    PerfStats::Summary perfSummary = perf ? perf->summary() : PerfStats::Summary{};
+    snprintf(buf, sizeof(buf), "FRAME: %.2fms", perfSummary.frameP50 * 1000);
+    header_view.paint(win, SLOT_FRAME, 1, 25, A_NORMAL, buf);
+
+    // CPU Load Bar, one segment per started 2% of a core
+    int load = std::min(15, (int)std::ceil(perfSummary.cpuPercent / 2.0));
+    if (load != lastCpuLoad) {
+        wmove(win, 1, 51);
+        for (int i = 0; i < 15; i++) {
+            if (i < load) waddch(win, '|' | COLOR_PAIR(1));
+            else waddch(win, '.' | A_DIM);
+        }
+        waddch(win, ']');
+        lastCpuLoad = load;
     }
+    snprintf(buf, sizeof(buf), "%.1f%%", perfSummary.cpuPercent);
+    header_view.paint(win, SLOT_CPU, 1, 68, A_NORMAL, buf, 7);
+
+    header_view.paint(win, SLOT_SAVED, 1, maxX - 30, COLOR_PAIR(1) | A_BOLD,
+                      game.autosaveFeedbackTimer > 0 ? "[ SYSTEM: PROGRESS SAVED ]" : "");
+
+    // Sits on the bottom border, so clearing it has to put the border back
+    header_view.paint(win, SLOT_SIGNAL, 2, maxX - 65, COLOR_PAIR(3) | A_BLINK | A_BOLD,
+                      game.cacheOnScreen ? " [!] ANOMALOUS SIGNAL DETECTED - PRESS 'g' TO INTERCEPT [!] " : "",
+                      -1, ACS_HLINE);
 }
 
 void Renderer::drawStats(const Game& game) {
     WINDOW* win = stats_win->get();
-    wattron(win, COLOR_PAIR(3) | A_BOLD);
-    mvwprintw(win, 0, 2, " [ TERMINAL ] ");
-    wattroff(win, COLOR_PAIR(3) | A_BOLD);
+    char buf[256];
+    char num[32];
 
-    mvwprintw(win, 2, 2, "TARGET: Blackwall");
-    wattron(win, A_REVERSE);
-    mvwprintw(win, 3, 2, " PRESS SPACE TO BREACH ");
-    wattroff(win, A_REVERSE);
-    
-    mvwprintw(win, 5, 2, "DATA BANK:       %s", Utils::formatNumber(game.lines).c_str());
-    mvwprintw(win, 6, 2, "DATA PER SEC:    %s", Utils::formatNumber(game.linesPerSecond * game.buffs).c_str());
+    if (stats_view.numberChanged(SLOT_BANK, game.lines, notation)) {
+        Utils::formatNumber(game.lines, num, sizeof(num), notation);
+        snprintf(buf, sizeof(buf), "DATA BANK:       %s", num);
+        stats_view.paint(win, SLOT_BANK, 5, 2, A_NORMAL, buf);
+    }
+    const Economy& econ = game.economy();
+    double rate = econ.rate;
+    if (stats_view.numberChanged(SLOT_RATE, rate, notation)) {
+        Utils::formatNumber(rate, num, sizeof(num), notation);
+        snprintf(buf, sizeof(buf), "DATA PER SEC:    %s", num);
+        stats_view.paint(win, SLOT_RATE, 6, 2, A_NORMAL, buf);
+    }
 
+    buf[0] = '\0';
     if (game.cacheBuffDurationTimer > 0) {
-        wattron(win, COLOR_PAIR(1) | A_BOLD);
-        mvwprintw(win, 7, 2, "%s (%.1fs)", game.activeAlert.c_str(), game.cacheBuffDurationTimer);
-        wattroff(win, COLOR_PAIR(1) | A_BOLD);
+        snprintf(buf, sizeof(buf), "%s (%.1fs)", game.activeAlert.c_str(), game.cacheBuffDurationTimer);
+    }
+    stats_view.paint(win, SLOT_ALERT, 7, 2, COLOR_PAIR(1) | A_BOLD, buf);
+
+    snprintf(buf, sizeof(buf), "[B] Overclock Multiplier: x%.2f", game.buffs);
+    stats_view.paint(win, SLOT_BUFF, 9, 2, A_NORMAL, buf);
+    BigNum buffCost = econ.buffCost;
+    const char* text = stats_view.text(SLOT_BUFF_COST);
+    if (stats_view.numberChanged(SLOT_BUFF_COST, buffCost, notation)) {
+        Utils::formatNumber(buffCost, num, sizeof(num), notation);
+        snprintf(buf, sizeof(buf), "Cost: %s DATA", num);
+        text = buf;
+    }
+    stats_view.paint(win, SLOT_BUFF_COST, 10, 6, COLOR_PAIR(game.lines >= buffCost ? 1 : 2), text);
+
+    snprintf(buf, sizeof(buf), "[C] Breach DATA/SEC share: %.0f%%", game.lpsToClick * 100);
+    stats_view.paint(win, SLOT_SHARE, 12, 2, A_NORMAL, buf);
+    BigNum shareCost = econ.clickShareCost;
+    text = stats_view.text(SLOT_SHARE_COST);
+    if (stats_view.numberChanged(SLOT_SHARE_COST, shareCost, notation)) {
+        Utils::formatNumber(shareCost, num, sizeof(num), notation);
+        snprintf(buf, sizeof(buf), "Cost: %s DATA", num);
+        text = buf;
     }
+    stats_view.paint(win, SLOT_SHARE_COST, 13, 6, COLOR_PAIR(game.lines >= shareCost ? 1 : 2), text);
 
-    mvwprintw(win, 9, 2, "[B] Overclock Multiplier: x%.2f", game.buffs);
-    if (game.lines >= game.getBuffCost()) wattron(win, COLOR_PAIR(1)); else wattron(win, COLOR_PAIR(2));
-    mvwprintw(win, 10, 6, "Cost: %s DATA", Utils::formatNumber(game.getBuffCost()).c_str());
-    wattroff(win, COLOR_PAIR(1)); wattroff(win, COLOR_PAIR(2));
+    drawLog(game);
+}
 
-    mvwprintw(win, 12, 2, "[C] Breach DATA/SEC share: %.0f%%", game.lpsToClick * 100);
-    if (game.lines >= game.getClickShareCost()) wattron(win, COLOR_PAIR(1)); else wattron(win, COLOR_PAIR(2));
-    mvwprintw(win, 13, 6, "Cost: %s DATA", Utils::formatNumber(game.getClickShareCost()).c_str());
-    wattroff(win, COLOR_PAIR(1)); wattroff(win, COLOR_PAIR(2));
+// Data Stream Log, below the header line drawn with the chrome. Entries are
+// only formatted when the visible window onto the log has moved.
+void Renderer::drawLog(const Game& game) {
+    const LogRing& log = game.actionLog;
+    uint64_t pushed = log.pushed();
+    // While scrolled back, stay on the same entries as new ones arrive
+    if (logScroll > 0) logScroll += (int)(pushed - logDrawnPushed);
+    logScroll = std::clamp(logScroll, 0, std::max(0, log.size() - EYE_CANDY_LOG_SIZE));
+    if (pushed == logDrawnPushed && logScroll == logDrawnScroll) return;
+    logDrawnPushed = pushed;
+    logDrawnScroll = logScroll;
 
-    // Data Stream Log
-    int startLine = 15;
-    wattron(win, A_DIM | A_BOLD);
-    mvwprintw(win, startLine++, 2, "--- LOG_STREAM_INITIALIZED ---");
-    wattroff(win, A_DIM | A_BOLD);
-    
-    for (size_t i = 0; i < game.actionLog.size(); i++) {
-        mvwprintw(win, startLine + i, 2, "> %s", game.actionLog[i].c_str());
+    WINDOW* win = stats_win->get();
+    char buf[256];
+    buf[0] = '\0';
+    if (logScroll > 0) snprintf(buf, sizeof(buf), "[-%d]", logScroll);
+    stats_view.paint(win, SLOT_LOG_SCROLL, 15, 33, A_DIM | A_BOLD, buf);
+
+    int startLine = 16;
+    for (int i = 0; i < EYE_CANDY_LOG_SIZE; i++) {
+        int entry = logScroll + i;
+        buf[0] = '\0';
+        if (entry < log.size()) {
+            int n = snprintf(buf, sizeof(buf), "> ");
+            game.formatLog(log[entry], buf + n, sizeof(buf) - n, notation);
+        }
+        stats_view.paint(win, SLOT_LOG + i, startLine + i, 2, A_NORMAL, buf);
     }
 }
 
+void Renderer::scrollLog(int pages) {
+    logScroll = std::max(0, logScroll + pages * EYE_CANDY_LOG_SIZE);
+}
+
 void Renderer::moveSelection(int dir, int max) {
     selectedBuildingIndex += dir;
     if (selectedBuildingIndex < 0) selectedBuildingIndex = 0;
     if (selectedBuildingIndex >= max) selectedBuildingIndex = max - 1;
 }
 
+void Renderer::cycleBuyAmount() {
+    switch (buyAmount) {
+        case 1: buyAmount = 10; break;
+        case 10: buyAmount = 100; break;
+        case 100: buyAmount = BUY_MAX; break;
+        default: buyAmount = 1; break;
+    }
+}
+
 void Renderer::drawShop(const Game& game) {
     WINDOW* win = shop_win->get();
-    wattron(win, COLOR_PAIR(3) | A_BOLD);
-    mvwprintw(win, 0, 2, " [ BLACK MARKET ] ");
-    wattroff(win, COLOR_PAIR(3) | A_BOLD);
-
-    wattron(win, A_BOLD);
-    mvwprintw(win, 2, 2, "QUICKHACKS");
-    mvwprintw(win, 3, 2, "------------------------------------------");
-    wattroff(win, A_BOLD);
+    char buf[256];
+    char num[32];
 
     // Calculate how many items can be displayed
     // Start at y=5, each item is 2 lines. Box and title use some space.
     int winHeight, winWidth;
     getmaxyx(win, winHeight, winWidth);
-    (void)winWidth;
     int displayableCount = (winHeight - 6) / 2;
     if (displayableCount < 1) displayableCount = 1;
 
-    // Static scrolling offset calculation to keep selection in view
-    static int scrollOffset = 0;
-    if (selectedBuildingIndex < scrollOffset) {
-        scrollOffset = selectedBuildingIndex;
-    } else if (selectedBuildingIndex >= scrollOffset + displayableCount) {
-        scrollOffset = selectedBuildingIndex - displayableCount + 1;
+    // Buy amount and scroll arrows, then name/lps/cost slots for each visible row
+    const int SLOT_AMOUNT = 0, SLOT_ARROW_UP = 1, SLOT_ARROW_DOWN = 2, SLOT_ROWS = 3;
+    if (shop_view.size() != SLOT_ROWS + displayableCount * 3) {
+        shop_view.reset(SLOT_ROWS + displayableCount * 3);
+        shopCosts.resize(displayableCount);
+        shopAffordable.resize(displayableCount);
+    }
+
+    if (buyAmount == BUY_MAX) snprintf(buf, sizeof(buf), "[x] BUY: MAX");
+    else snprintf(buf, sizeof(buf), "[x] BUY: x%d", buyAmount);
+    shop_view.paint(win, SLOT_AMOUNT, 2, 14, A_NORMAL, buf);
+
+    // Scroll just enough to keep the selection in view
+    if (selectedBuildingIndex < shopScroll) {
+        shopScroll = selectedBuildingIndex;
+    } else if (selectedBuildingIndex >= shopScroll + displayableCount) {
+        shopScroll = selectedBuildingIndex - displayableCount + 1;
     }
 
-    int endIndex = scrollOffset + displayableCount;
+    int endIndex = shopScroll + displayableCount;
     if (endIndex > (int)game.buildings.size()) endIndex = game.buildings.size();
 
-    for (int i = scrollOffset; i < endIndex; i++) {
-        int relativeIdx = i - scrollOffset;
-        int y_pos = 5 + (relativeIdx * 2);
+    // Prices for the current buy amount and whether they're affordable, for
+    // the visible rows in one pass each
+    const BuildingTable& table = game.buildings;
+    table.costsOf(buyAmount, game.lines, shopScroll, endIndex, shopCosts.data());
+    table.affordable(buyAmount, game.lines, shopScroll, endIndex, shopAffordable.data());
+
+    for (int row = 0; row < displayableCount; row++) {
+        int i = shopScroll + row;
+        int y_pos = 5 + (row * 2);
+        int slot = SLOT_ROWS + row * 3;
+
+        if (i >= endIndex) {
+            shop_view.paint(win, slot, y_pos, 2, A_NORMAL, "");
+            shop_view.paint(win, slot + 1, y_pos + 1, 6, A_NORMAL, "");
+            shop_view.paint(win, slot + 2, y_pos + 1, 22, A_NORMAL, "");
+            continue;
+        }
 
         bool isSelected = (i == selectedBuildingIndex);
-        if (isSelected) wattron(win, A_BOLD);
+        attr_t bold = isSelected ? A_BOLD : A_NORMAL;
 
         if (isSelected) {
-            mvwprintw(win, y_pos, 2, "[%zu] [[ %-10s ]] (Owned: %d)", 
-                     (size_t)i, game.buildings[i].name.c_str(), game.buildings[i].count);
+            snprintf(buf, sizeof(buf), "[%zu] [[ %-10s ]] (Owned: %d)", (size_t)i, table.getName(i).c_str(), table.getCount(i));
         } else {
-            mvwprintw(win, y_pos, 2, "[%zu]    %-10s    (Owned: %d)", 
-                     (size_t)i, game.buildings[i].name.c_str(), game.buildings[i].count);
+            snprintf(buf, sizeof(buf), "[%zu]    %-10s    (Owned: %d)", (size_t)i, table.getName(i).c_str(), table.getCount(i));
         }
-
-        mvwprintw(win, y_pos + 1, 6, "+%s D/s  |", Utils::formatNumber(game.buildings[i].baselps).c_str());
-
-        double cost = game.buildings[i].getNextCost();
-        if (game.lines >= cost) {
-            wattron(win, COLOR_PAIR(1)); 
-        } else {
-            wattron(win, COLOR_PAIR(2)); 
+        shop_view.paint(win, slot, y_pos, 2, bold, buf);
+
+        // Clipped so an oversized rate can't run into the cost column
+        const char* text = shop_view.text(slot + 1);
+        if (shop_view.numberChanged(slot + 1, table.getBaseLps(i), notation)) {
+            Utils::formatNumber(table.getBaseLps(i), num, sizeof(num), notation);
+            snprintf(buf, sizeof(buf), "+%s D/s  |", num);
+            text = buf;
         }
-        mvwprintw(win, y_pos + 1, 22, " Cost: %s", Utils::formatNumber(cost).c_str());
-        wattroff(win, COLOR_PAIR(1));
-        wattroff(win, COLOR_PAIR(2));
-
-        if (isSelected) {
-            wattroff(win, A_BOLD);
+        shop_view.paint(win, slot + 1, y_pos + 1, 6, bold, text, 16);
+
+        BigNum cost = shopCosts[row];
+        text = shop_view.text(slot + 2);
+        if (shop_view.numberChanged(slot + 2, cost, notation)) {
+            Utils::formatNumber(cost, num, sizeof(num), notation);
+            snprintf(buf, sizeof(buf), " Cost: %s", num);
+            text = buf;
         }
+        shop_view.paint(win, slot + 2, y_pos + 1, 22, bold | COLOR_PAIR(shopAffordable[row] ? 1 : 2), text);
     }
-    if (scrollOffset > 0) mvwprintw(win, 4, winWidth - 3, "^");
-    if (endIndex < (int)game.buildings.size()) mvwprintw(win, winHeight - 2, winWidth - 3, "v");
+    shop_view.paint(win, SLOT_ARROW_UP, 4, winWidth - 3, A_NORMAL, shopScroll > 0 ? "^" : "");
+    shop_view.paint(win, SLOT_ARROW_DOWN, winHeight - 2, winWidth - 3, A_NORMAL,
+                    endIndex < (int)game.buildings.size() ? "v" : "");
 }
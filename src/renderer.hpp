@@ -1,32 +1,65 @@
 #pragma once
 
 #include <ncurses.h>
+#include <chrono>
 #include <memory>
 #include <vector>
 #include <string>
 #include "game.hpp"
 #include "window.hpp"
+#include "view_model.hpp"
+#include "perf_stats.hpp"
 
 class Renderer {
 public:
-    Renderer();
+    explicit Renderer(SCREEN* screen = nullptr);
     ~Renderer();
 
     void render(const Game& game);
+    double nextRedrawIn(const Game& game) const;
     void handleResize();
     void moveSelection(int dir, int max);
     int getSelectedIndex() const { return selectedBuildingIndex; }
-    void drawSplashScreen();
+    void cycleBuyAmount();
+    int getBuyAmount() const { return buyAmount; }
+    // Waits for a key; returns when the splash first reached the terminal
+    std::chrono::steady_clock::time_point drawSplashScreen(const std::vector<std::string>& banner);
+    void attachPerfStats(const PerfStats* stats) { perf = stats; }
+    void togglePerfOverlay();
+    void scrollLog(int pages);
+    double getLastFlushTime() const { return lastFlushTime; }
+    // How DATA amounts past the suffix table are written; repaints everything
+    void setNotation(Utils::Notation n) { notation = n; layoutDirty = true; }
 
 private:
     std::unique_ptr<Window> header_win;
     std::unique_ptr<Window> stats_win;
     std::unique_ptr<Window> shop_win;
+    std::unique_ptr<Window> perf_win;
     int maxY, maxX;
     int selectedBuildingIndex = 0;
-    std::vector<std::string> splashBanner;
+    int shopScroll = 0;             // first building row shown in the shop
+    int buyAmount = 1;
+    Utils::Notation notation = Utils::Notation::ENGINEERING;
+    std::vector<BigNum> shopCosts;          // per visible shop row
+    std::vector<uint8_t> shopAffordable;
+    ViewModel header_view;
+    ViewModel stats_view;
+    ViewModel shop_view;
+    ViewModel perf_view;
+    const PerfStats* perf = nullptr;
+    double lastFlushTime = 0;
+    int lastCpuLoad = -1;
+    bool layoutDirty = true;
+    int logScroll = 0;              // entries scrolled back from the newest
+    uint64_t logDrawnPushed = 0;
+    int logDrawnScroll = -1;        // -1 forces the log to be redrawn
 
+    void drawChrome();
     void drawHeader(const Game& game);
     void drawStats(const Game& game);
     void drawShop(const Game& game);
+    void drawLog(const Game& game);
+    void drawPerfOverlay();
+    void placePerfOverlay();
 };
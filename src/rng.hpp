@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+enum RngStream {
+    RNG_GAMEPLAY = 0,   // anything that changes game state
+    RNG_EYE_CANDY = 1,  // cosmetic only, never saved
+};
+
+// xoshiro256** (Blackman & Vigna). Small, fast and plenty for gameplay; each
+// Game owns its streams, so there is no shared hidden state like std::rand's.
+class Rng {
+public:
+    // Streams from the same seed are 2^128 draws apart, so they never overlap
+    explicit Rng(uint64_t seed = 0, int stream = 0) {
+        // splitmix64 spreads the seed over the whole state
+        for (auto& word : s) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+        for (int i = 0; i < stream; i++) jump();
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, n) by multiply-shift; the bias is negligible for the
+    // small ranges the game asks for
+    uint32_t below(uint32_t n) {
+        return (uint32_t)(((next() >> 32) * n) >> 32);
+    }
+
+    uint32_t next32() { return (uint32_t)(next() >> 32); }
+
+    // Raw state, for saving and restoring a stream mid-sequence
+    const uint64_t* state() const { return s; }
+    void setState(const uint64_t state[4]) {
+        for (int i = 0; i < 4; i++) s[i] = state[i];
+    }
+
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // Equivalent to 2^128 calls to next()
+    void jump() {
+        static const uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+        uint64_t t[4] = {0, 0, 0, 0};
+        for (uint64_t j : JUMP) {
+            for (int b = 0; b < 64; b++) {
+                if (j & (1ULL << b)) {
+                    for (int i = 0; i < 4; i++) t[i] ^= s[i];
+                }
+                next();
+            }
+        }
+        for (int i = 0; i < 4; i++) s[i] = t[i];
+    }
+};
@@ -0,0 +1,138 @@
+#include "save_format.hpp"
+#include "constants.hpp"
+#include "json.hpp"
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using json = nlohmann::json;
+
+namespace {
+
+// FNV-1a; cheap and plenty to catch torn or hand-edited files
+uint32_t checksum(const unsigned char* data, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+}
+
+std::string encodeSave(const SaveSnapshot& snapshot) {
+    SaveState state = snapshot.state;
+    state.buildingCount = snapshot.buildings.size();
+    state.reserved = 0;
+
+    size_t payloadSize = sizeof(SaveState) + snapshot.buildings.size() * sizeof(SaveBuilding);
+    std::string out(sizeof(SaveHeader) + payloadSize, '\0');
+    unsigned char* payload = reinterpret_cast<unsigned char*>(out.data()) + sizeof(SaveHeader);
+    std::memcpy(payload, &state, sizeof(SaveState));
+    if (!snapshot.buildings.empty()) {
+        std::memcpy(payload + sizeof(SaveState), snapshot.buildings.data(),
+                    snapshot.buildings.size() * sizeof(SaveBuilding));
+    }
+
+    SaveHeader header = {SAVE_MAGIC, (uint16_t)VERSION, sizeof(SaveHeader),
+                         (uint32_t)payloadSize, checksum(payload, payloadSize)};
+    std::memcpy(out.data(), &header, sizeof(SaveHeader));
+    return out;
+}
+
+SaveReadStatus readSave(const std::string& path, SaveSnapshot& out, int& version) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return SaveReadStatus::MISSING;
+
+    // The whole file comes in with a single read
+    struct stat st;
+    std::vector<unsigned char> buf;
+    ssize_t got = -1;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(SaveHeader)) {
+        buf.resize(st.st_size);
+        got = read(fd, buf.data(), buf.size());
+    }
+    close(fd);
+    if (got != (ssize_t)buf.size() || buf.empty()) return SaveReadStatus::CORRUPT;
+    return decodeSave(buf.data(), buf.size(), out, version);
+}
+
+SaveReadStatus decodeSave(const unsigned char* data, size_t size, SaveSnapshot& out, int& version) {
+    if (size < sizeof(SaveHeader)) return SaveReadStatus::CORRUPT;
+    SaveHeader header;
+    std::memcpy(&header, data, sizeof(SaveHeader));
+    if (header.magic != SAVE_MAGIC) return SaveReadStatus::CORRUPT;
+    version = header.version;
+    if (header.version < 2 || header.version > VERSION) return SaveReadStatus::VERSION_MISMATCH;
+    // Older state is a prefix of the current one; the rest stays zero
+    size_t stateSize = header.version == 2 ? SAVE_STATE_V2_SIZE
+                     : header.version == 3 ? SAVE_STATE_V3_SIZE : sizeof(SaveState);
+    if (header.headerSize != sizeof(SaveHeader) ||
+        header.payloadSize != size - sizeof(SaveHeader) ||
+        header.payloadSize < stateSize) {
+        return SaveReadStatus::CORRUPT;
+    }
+
+    const unsigned char* payload = data + sizeof(SaveHeader);
+    if (checksum(payload, header.payloadSize) != header.checksum) return SaveReadStatus::CORRUPT;
+
+    out.state = SaveState{};
+    std::memcpy(&out.state, payload, stateSize);
+    size_t count = out.state.buildingCount;
+    if (header.payloadSize != stateSize + count * sizeof(SaveBuilding)) {
+        return SaveReadStatus::CORRUPT;
+    }
+    out.state.activeAlert[sizeof(out.state.activeAlert) - 1] = '\0';
+    out.buildings.resize(count);
+    if (count > 0) {
+        std::memcpy(out.buildings.data(), payload + stateSize, count * sizeof(SaveBuilding));
+    }
+    return SaveReadStatus::LOADED;
+}
+
+SaveReadStatus readLegacySave(const std::string& path, const BuildingTable& catalog, SaveSnapshot& out) {
+    std::ifstream saveFile(path);
+    if (!saveFile.is_open()) return SaveReadStatus::MISSING;
+
+    try {
+        json save_data = json::parse(saveFile);
+        if (save_data.value("version", 0) != 1) return SaveReadStatus::VERSION_MISMATCH;
+
+        SaveState& s = out.state;
+        s = SaveState{};
+        s.lines = save_data.value("lines", 0.0);
+        s.buffs = save_data.value("buffs", 1.0);
+        s.linesPerSecond = save_data.value("linesPerSecond", 0.0);
+        s.buffsBought = save_data.value("buffsBought", 0);
+        s.clickSharesBought = save_data.value("clickSharesBought", 0);
+        s.lpsToClick = save_data.value("lpsToClick", 0.0);
+        s.cacheBuffDurationTimer = save_data.value("cacheBuffDurationTimer", 0.0);
+        s.clickBoostPercent = save_data.value("clickBoostPercent", 1.0);
+        s.timestamp = save_data.value("timestamp", 0.0);
+        std::string alert = save_data.value("activeAlert", "");
+        snprintf(s.activeAlert, sizeof(s.activeAlert), "%s", alert.c_str());
+
+        std::unordered_map<std::string, int> idsByName;
+        for (int i = 0; i < catalog.size(); i++) {
+            idsByName.emplace(catalog.getName(i), catalog.getId(i));
+        }
+
+        out.buildings.clear();
+        if (save_data.contains("buildings") && save_data["buildings"].is_array()) {
+            for (const auto& b_data : save_data["buildings"]) {
+                auto it = idsByName.find(b_data.value("name", ""));
+                if (it != idsByName.end()) {
+                    out.buildings.push_back({(uint32_t)it->second, b_data.value("count", 0)});
+                }
+            }
+        }
+        s.buildingCount = out.buildings.size();
+    } catch (const std::exception& e) {
+        return SaveReadStatus::CORRUPT;
+    }
+    return SaveReadStatus::LOADED;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include "building.hpp"
+
+// -- Binary save layout (VERSION 4) -- //
+// [SaveHeader][SaveState][SaveBuilding x state.buildingCount], native byte
+// order. The checksum covers everything after the header. VERSION 2 and 3
+// saves are the same minus the trailing fields of SaveState and still load.
+
+const uint32_t SAVE_MAGIC = 0x44475243; // "CRGD"
+
+struct SaveHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t payloadSize;
+    uint32_t checksum;
+};
+
+struct SaveState {
+    double lines;           // DATA is lines * 2^linesScale
+    double buffs;
+    double linesPerSecond;
+    double lpsToClick;
+    double cacheBuffDurationTimer;
+    double clickBoostPercent;
+    double timestamp;
+    int32_t buffsBought;
+    int32_t clickSharesBought;
+    char activeAlert[96];
+    uint32_t buildingCount;
+    uint32_t reserved;
+    // VERSION 3
+    uint64_t rngSeed;       // 0 if the save predates seeding
+    uint64_t rngState[4];   // gameplay stream position
+    // VERSION 4
+    int64_t linesScale;     // 0 while DATA fits in a double
+};
+
+const size_t SAVE_STATE_V2_SIZE = 168;
+const size_t SAVE_STATE_V3_SIZE = 208;
+
+struct SaveBuilding {
+    uint32_t id;
+    int32_t count;
+};
+
+static_assert(std::is_trivially_copyable_v<SaveHeader> && sizeof(SaveHeader) == 16);
+static_assert(std::is_trivially_copyable_v<SaveState> && sizeof(SaveState) == 216);
+static_assert(std::is_trivially_copyable_v<SaveBuilding> && sizeof(SaveBuilding) == 8);
+
+// Everything saveGame persists, copied out of Game so the writer thread never
+// touches live state
+struct SaveSnapshot {
+    SaveState state;
+    std::vector<SaveBuilding> buildings;
+};
+
+enum class SaveReadStatus {
+    LOADED,
+    MISSING,
+    CORRUPT,
+    VERSION_MISMATCH
+};
+
+std::string encodeSave(const SaveSnapshot& snapshot);
+SaveReadStatus readSave(const std::string& path, SaveSnapshot& out, int& version);
+// The same checks as readSave, on an encoded save already in memory
+SaveReadStatus decodeSave(const unsigned char* data, size_t size, SaveSnapshot& out, int& version);
+// One-way import of a VERSION 1 JSON save; buildings are matched by name
+SaveReadStatus readLegacySave(const std::string& path, const BuildingTable& catalog, SaveSnapshot& out);
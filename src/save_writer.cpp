@@ -0,0 +1,88 @@
+#include "save_writer.hpp"
+#include "constants.hpp"
+#include "trace.hpp"
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+SaveWriter::SaveWriter(const std::string& savePath) : savePath(savePath) {
+    fs::path p(savePath);
+    fileName = p.filename().string();
+    legacySavePath = (p.parent_path() / LEGACY_SAVE_FILE_NAME).string();
+    std::string dir = p.has_parent_path() ? p.parent_path().string() : ".";
+    dirFd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    worker = std::thread(&SaveWriter::run, this);
+}
+
+SaveWriter::~SaveWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+    if (dirFd >= 0) close(dirFd);
+}
+
+void SaveWriter::submit(const SaveSnapshot& snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        pending = snapshot;
+        hasPending = true;
+    }
+    cv.notify_all();
+}
+
+void SaveWriter::flush() {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [this] { return !hasPending && !writing; });
+}
+
+void SaveWriter::run() {
+    SaveSnapshot current;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        cv.wait(lock, [this] { return hasPending || stopping; });
+        // Pending work is still written on shutdown so the exit save lands
+        if (!hasPending) break;
+
+        std::swap(current, pending);
+        hasPending = false;
+        writing = true;
+        lock.unlock();
+        write(current);
+        lock.lock();
+        writing = false;
+        cv.notify_all();
+    }
+}
+
+void SaveWriter::write(const SaveSnapshot& snapshot) {
+    TRACE_SCOPE("SaveWriter::write");
+    std::string data = encodeSave(snapshot);
+
+    if (dirFd < 0) return;
+    std::string tmpName = fileName + ".tmp";
+    int fd = openat(dirFd, tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return;
+
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0) break;
+        written += n;
+    }
+    bool ok = written == data.size() && fsync(fd) == 0;
+    close(fd);
+
+    if (!ok) {
+        unlinkat(dirFd, tmpName.c_str(), 0);
+        return;
+    }
+    if (renameat(dirFd, tmpName.c_str(), dirFd, fileName.c_str()) == 0) {
+        fsync(dirFd);
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "save_format.hpp"
+
+// Writes save snapshots on a background thread. The save directory is
+// resolved and opened once; each write goes to a temp file that is fsynced
+// and renamed over the real save, so a crash mid-write leaves the previous
+// save intact. Only the newest pending snapshot is kept.
+class SaveWriter {
+public:
+    explicit SaveWriter(const std::string& savePath);
+    ~SaveWriter();
+
+    SaveWriter(const SaveWriter&) = delete;
+    SaveWriter& operator=(const SaveWriter&) = delete;
+
+    void submit(const SaveSnapshot& snapshot);
+    // Block until everything submitted so far is on disk
+    void flush();
+    const std::string& path() const { return savePath; }
+    const std::string& legacyPath() const { return legacySavePath; }
+
+private:
+    std::string savePath;
+    std::string legacySavePath;
+    std::string fileName;
+    int dirFd;
+
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cv;
+    SaveSnapshot pending;
+    bool hasPending = false;
+    bool writing = false;
+    bool stopping = false;
+
+    void run();
+    void write(const SaveSnapshot& snapshot);
+};
@@ -0,0 +1,338 @@
+#include "session.hpp"
+#include "save_format.hpp"
+#include "utils.hpp"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <cstdlib>
+#include <filesystem>
+
+using Clock = std::chrono::steady_clock;
+using Duration = std::chrono::duration<double>;
+
+namespace {
+
+struct Fnv1a {
+    uint64_t h = 1469598103934665603ULL;
+
+    void mix(const void* data, size_t len) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < len; i++) {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+    }
+};
+
+// Bounds-checked reads over a loaded session log
+class Reader {
+public:
+    Reader(const std::vector<unsigned char>& data) : data(data) {}
+
+    template <typename T> bool get(T& value) {
+        if (data.size() - pos < sizeof(T)) return false;
+        std::memcpy(&value, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    const unsigned char* take(size_t len) {
+        if (data.size() - pos < len) return nullptr;
+        const unsigned char* p = data.data() + pos;
+        pos += len;
+        return p;
+    }
+
+    bool done() const { return pos == data.size(); }
+
+private:
+    const std::vector<unsigned char>& data;
+    size_t pos = 0;
+};
+
+}
+
+uint64_t stateChecksum(const Game& game) {
+    SaveSnapshot snap = game.snapshot();
+    snap.state.timestamp = 0;
+
+    Fnv1a f;
+    f.mix(&snap.state, sizeof(snap.state));
+    f.mix(snap.buildings.data(), snap.buildings.size() * sizeof(SaveBuilding));
+    double timers[] = {game.autosaveTimer, game.cacheSpawnTimer, game.cacheActiveTimer,
+                       game.feedbackTimer, game.autosaveFeedbackTimer};
+    f.mix(timers, sizeof(timers));
+    uint8_t onScreen = game.cacheOnScreen;
+    f.mix(&onScreen, 1);
+    double carry[] = {game.linesCarry.mantissa(), (double)game.linesCarry.exponent()};
+    f.mix(carry, sizeof(carry));
+    return f.h;
+}
+
+SessionRecorder::~SessionRecorder() {
+    if (out) fclose(out);
+}
+
+bool SessionRecorder::open(const std::string& path, uint64_t seed) {
+    out = fopen(path.c_str(), "wb");
+    if (!out) return false;
+    SessionHeader header = {SESSION_MAGIC, SESSION_VERSION, sizeof(SessionHeader), seed};
+    put(header);
+    last = Clock::now();
+    return true;
+}
+
+void SessionRecorder::begin(SessionRecord type) {
+    Clock::time_point now = Clock::now();
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(now - last).count();
+    last = now;
+    put(type);
+    put((uint32_t)std::min<long long>(micros, UINT32_MAX));
+}
+
+void SessionRecorder::frame(double dt) {
+    if (!out) return;
+    begin(SessionRecord::FRAME);
+    put(dt);
+}
+
+void SessionRecorder::command(const Command& cmd) {
+    if (!out) return;
+    begin(SessionRecord::COMMAND);
+    put((uint8_t)cmd.action);
+    put((int32_t)cmd.index);
+    put((int32_t)cmd.amount);
+}
+
+void SessionRecorder::hold(int count) {
+    if (!out) return;
+    begin(SessionRecord::HOLD);
+    put((int32_t)count);
+}
+
+void SessionRecorder::snapshot(const Game& game) {
+    if (!out) return;
+    std::string data = encodeSave(game.snapshot());
+    begin(SessionRecord::SNAPSHOT);
+    put((uint32_t)data.size());
+    fwrite(data.data(), 1, data.size(), out);
+    // A load's offline credit can leave a carry, and every later credit sees it
+    put(game.linesCarry.mantissa());
+    put(game.linesCarry.exponent());
+}
+
+void SessionRecorder::finish(const Game& game) {
+    if (!out) return;
+    begin(SessionRecord::END);
+    put(stateChecksum(game));
+    fclose(out);
+    out = nullptr;
+}
+
+void CommandDispatcher::apply(const Command& cmd) {
+    if (cmd.action == GameAction::NONE) return;
+    if (recorder) recorder->command(cmd);
+    if (cmd.action != GameAction::BREACH) flush();
+
+    switch (cmd.action) {
+        case GameAction::BREACH:
+            breaches++;
+            break;
+        case GameAction::BREACH_PRESS:
+            if (!held) game.registerClick();
+            held = true;
+            break;
+        case GameAction::BREACH_RELEASE:
+            held = false;
+            break;
+        case GameAction::BUY_BUFF:
+            game.buyBuff();
+            break;
+        case GameAction::BUY_CLICK_SHARE:
+            game.buyClickShare();
+            break;
+        case GameAction::SAVE:
+            game.saveGame();
+            break;
+        case GameAction::LOAD:
+            // A load depends on the disk and the wall clock; log what it produced
+            game.loadGame();
+            if (recorder) recorder->snapshot(game);
+            break;
+        case GameAction::CATCH_CACHE:
+            game.catchCache();
+            break;
+        case GameAction::BUY_SELECTED:
+            game.buyBuilding(cmd.index, cmd.amount);
+            break;
+        case GameAction::SELL_SELECTED:
+            game.sellBuilding(cmd.index, cmd.amount);
+            break;
+        default:
+            break;
+    }
+}
+
+void CommandDispatcher::hold(int count) {
+    if (count <= 0) return;
+    flush();
+    if (recorder) recorder->hold(count);
+    game.registerClicks(count);
+}
+
+void CommandDispatcher::frame(double dt) {
+    flush();
+    game.runCycle(dt);
+    game.updateTimers(dt);
+    if (recorder) recorder->frame(dt);
+}
+
+void CommandDispatcher::flush() {
+    if (breaches == 0) return;
+    game.registerClicks(breaches);
+    breaches = 0;
+}
+
+namespace {
+
+// The replay proper, with its Game scoped so the save writer is joined
+// before runReplay removes the save directory
+int replayLog(const std::string& path, Reader& in, uint64_t seed, const std::string& saveDir,
+              const std::string& catalogPath, const std::atomic<bool>& keepRunning) {
+    Game game(0, 1.0, seed, saveDir);
+    if (!catalogPath.empty() && !game.loadBuildings(catalogPath)) {
+        fprintf(stderr, "replay: cannot load building catalog %s\n", catalogPath.c_str());
+        return 1;
+    }
+    CommandDispatcher dispatcher(game);
+
+    long long frames = 0, commands = 0;
+    double simTime = 0, recordedWall = 0;
+    bool hasChecksum = false, truncated = false;
+    uint64_t recordedChecksum = 0;
+    Clock::time_point start = Clock::now();
+
+    while (keepRunning && !in.done() && !hasChecksum) {
+        uint8_t type;
+        uint32_t micros;
+        if (!in.get(type) || !in.get(micros)) {
+            truncated = true;
+            break;
+        }
+        recordedWall += micros * 1e-6;
+
+        bool ok = true;
+        switch ((SessionRecord)type) {
+            case SessionRecord::FRAME: {
+                double dt;
+                ok = in.get(dt);
+                if (ok) {
+                    dispatcher.frame(dt);
+                    simTime += dt;
+                    frames++;
+                }
+                break;
+            }
+            case SessionRecord::COMMAND: {
+                uint8_t action;
+                int32_t index, amount;
+                ok = in.get(action) && in.get(index) && in.get(amount);
+                if (!ok) break;
+                commands++;
+                Command cmd = {(GameAction)action, index, amount};
+                // The SNAPSHOT that follows stands in for the load itself
+                if (cmd.action == GameAction::LOAD) dispatcher.flush();
+                else dispatcher.apply(cmd);
+                break;
+            }
+            case SessionRecord::HOLD: {
+                int32_t count;
+                ok = in.get(count);
+                if (ok) dispatcher.hold(count);
+                break;
+            }
+            case SessionRecord::SNAPSHOT: {
+                uint32_t size;
+                const unsigned char* bytes = nullptr;
+                ok = in.get(size) && (bytes = in.take(size)) != nullptr;
+                SaveSnapshot snap;
+                int version;
+                double carry;
+                int64_t carryExp;
+                ok = ok && decodeSave(bytes, size, snap, version) == SaveReadStatus::LOADED &&
+                     in.get(carry) && in.get(carryExp);
+                if (ok) {
+                    game.applySnapshot(snap);
+                    game.linesCarry = BigNum::fromParts(carry, carryExp);
+                }
+                break;
+            }
+            case SessionRecord::END:
+                ok = in.get(recordedChecksum);
+                hasChecksum = ok;
+                break;
+            default:
+                ok = false;
+                break;
+        }
+        if (!ok) {
+            truncated = true;
+            break;
+        }
+    }
+    dispatcher.flush();
+
+    double wall = Duration(Clock::now() - start).count();
+    uint64_t checksum = stateChecksum(game);
+
+    printf("frames:         %lld\n", frames);
+    printf("commands:       %lld\n", commands);
+    printf("simulated:      %.3f s\n", simTime);
+    printf("recorded wall:  %.3f s\n", recordedWall);
+    printf("wall:           %.6f s\n", wall);
+    printf("speedup:        %.1fx\n", wall > 0 ? simTime / wall : 0.0);
+    printf("lines:          %.6g (%s)\n", game.lines.toDouble(), Utils::formatNumber(game.lines).c_str());
+    printf("checksum:       %016llx\n", (unsigned long long)checksum);
+    if (truncated) fprintf(stderr, "replay: %s is truncated or damaged\n", path.c_str());
+    if (!hasChecksum) {
+        printf("recorded:       none\n");
+        return truncated ? 1 : 0;
+    }
+    printf("recorded:       %016llx (%s)\n", (unsigned long long)recordedChecksum,
+           checksum == recordedChecksum ? "match" : "MISMATCH");
+    return checksum == recordedChecksum ? 0 : 1;
+}
+
+}
+
+int runReplay(const std::string& path, const std::string& catalogPath, const std::atomic<bool>& keepRunning) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open()) {
+        fprintf(stderr, "replay: cannot read %s\n", path.c_str());
+        return 1;
+    }
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    Reader in(data);
+
+    SessionHeader header;
+    if (!in.get(header) || header.magic != SESSION_MAGIC || header.headerSize != sizeof(SessionHeader)) {
+        fprintf(stderr, "replay: %s is not a session log\n", path.c_str());
+        return 1;
+    }
+    if (header.version != SESSION_VERSION) {
+        fprintf(stderr, "replay: unsupported session log version %d\n", header.version);
+        return 1;
+    }
+
+    // Saves made during the replay must not land on the real save
+    char tmpl[] = "/tmp/cybergrind-replay-XXXXXX";
+    if (!mkdtemp(tmpl)) {
+        fprintf(stderr, "replay: cannot create a save directory\n");
+        return 1;
+    }
+    int rc = replayLog(path, in, header.seed, tmpl, catalogPath, keepRunning);
+    std::error_code ec;
+    std::filesystem::remove_all(tmpl, ec);
+    return rc;
+}
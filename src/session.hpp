@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include "game.hpp"
+#include "input_handler.hpp"
+
+// -- Session log -- //
+// [SessionHeader] then records, each "type(u8) micros(u32) payload" where
+// micros is wall time since the previous record. Payloads:
+//   FRAME     dt(f64)                       runCycle + updateTimers
+//   COMMAND   action(u8) index(i32) amount(i32)
+//   HOLD      count(i32)                    breaches from a held space
+//   SNAPSHOT  size(u32) encoded save        state right after a load, then
+//             carry(f64) carryExp(i64)      linesCarry, which a save drops
+//   END       checksum(u64)                 stateChecksum at exit
+const uint32_t SESSION_MAGIC = 0x4c534743; // "CGSL"
+const uint16_t SESSION_VERSION = 3;   // 2: compensated income, see Game::credit; 3: carry in SNAPSHOT
+
+enum class SessionRecord : uint8_t {
+    FRAME = 1,
+    COMMAND = 2,
+    HOLD = 3,
+    SNAPSHOT = 4,
+    END = 5
+};
+
+struct SessionHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint64_t seed;          // Game's seed before the initial load
+};
+
+static_assert(sizeof(SessionHeader) == 16);
+
+// FNV-1a over everything that shapes future play: saved state, building
+// counts, RNG position, and the timers and income carry a save doesn't keep
+uint64_t stateChecksum(const Game& game);
+
+// Appends a session log through a buffered FILE, so recording a frame is a
+// few memcpys and no allocation
+class SessionRecorder {
+public:
+    SessionRecorder() = default;
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    bool open(const std::string& path, uint64_t seed);
+    void frame(double dt);
+    void command(const Command& cmd);
+    void hold(int count);
+    void snapshot(const Game& game);
+    void finish(const Game& game);
+
+private:
+    FILE* out = nullptr;
+    std::chrono::steady_clock::time_point last;
+
+    void begin(SessionRecord type);
+    template <typename T> void put(const T& value) { fwrite(&value, sizeof(value), 1, out); }
+};
+
+// Feeds commands to Game the way the main loop does, so live play and replays
+// take the same path. Breaches are batched until anything else happens or the
+// frame ends. UI-only actions are ignored; BUY/SELL must carry their index
+// and amount.
+class CommandDispatcher {
+public:
+    explicit CommandDispatcher(Game& game, SessionRecorder* recorder = nullptr)
+        : game(game), recorder(recorder) {}
+
+    void apply(const Command& cmd);
+    void hold(int count);
+    void frame(double dt);
+    // Credit batched breaches now
+    void flush();
+    bool breachHeld() const { return held; }
+
+private:
+    Game& game;
+    SessionRecorder* recorder;
+    int breaches = 0;
+    bool held = false;
+};
+
+// Re-runs a recorded session through Game on a virtual clock, as fast as
+// possible, and prints throughput and the final checksum. Returns non-zero
+// if the log is unreadable or the checksum differs from the recorded one.
+// A session played with --catalog needs the same catalogPath to replay.
+// Saves go to a scratch directory that is removed before returning.
+int runReplay(const std::string& path, const std::string& catalogPath, const std::atomic<bool>& keepRunning);
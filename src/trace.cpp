@@ -0,0 +1,122 @@
+#include "trace.hpp"
+
+#ifdef CYBERGRIND_TRACING
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace Trace {
+
+std::atomic<bool> active{false};
+
+namespace {
+
+struct Event {
+    const char* name;
+    uint64_t start;
+    uint64_t dur;
+    uint32_t tid;
+};
+
+// Producers append under a short lock; the writer swaps the whole buffer out
+// and does the formatting and file IO on its own thread
+const size_t FLUSH_THRESHOLD = 4096;
+
+std::mutex mtx;
+std::condition_variable cv;
+std::vector<Event> pending;
+bool stopping = false;
+std::thread writer;
+FILE* out = nullptr;
+bool firstEvent = true;
+const auto epoch = std::chrono::steady_clock::now();
+
+uint32_t currentTid() {
+    thread_local uint32_t tid = (uint32_t)syscall(SYS_gettid);
+    return tid;
+}
+
+void writeEvents(const std::vector<Event>& events) {
+    for (const Event& e : events) {
+        fprintf(out, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":%d,\"tid\":%u}",
+                firstEvent ? "\n" : ",\n", e.name, (unsigned long long)e.start,
+                (unsigned long long)e.dur, (int)getpid(), e.tid);
+        firstEvent = false;
+    }
+}
+
+void run() {
+    std::vector<Event> batch;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        cv.wait(lock, [] { return pending.size() >= FLUSH_THRESHOLD || stopping; });
+        batch.swap(pending);
+        bool done = stopping;
+        lock.unlock();
+        writeEvents(batch);
+        batch.clear();
+        lock.lock();
+        if (done) break;
+    }
+}
+
+}
+
+uint64_t nowMicros() {
+    // Never 0, which Scope uses to mean "not recording"
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - epoch).count() + 1;
+}
+
+void emit(const char* name, uint64_t start, uint64_t end) {
+    Event e = {name, start, end - start, currentTid()};
+    std::lock_guard<std::mutex> lock(mtx);
+    // Scopes still open on other threads at shutdown are dropped
+    if (stopping) return;
+    pending.push_back(e);
+    if (pending.size() >= FLUSH_THRESHOLD) cv.notify_one();
+}
+
+void init() {
+    const char* path = std::getenv("CYBERGRIND_TRACE");
+    if (!path || !*path || out) return;
+    out = fopen(path, "w");
+    if (!out) return;
+    setvbuf(out, nullptr, _IOFBF, 1 << 16);
+    fputs("[", out);
+    pending.reserve(FLUSH_THRESHOLD * 2);
+    stopping = false;
+    writer = std::thread(run);
+    active = true;
+}
+
+void shutdown() {
+    if (!out) return;
+    active = false;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_one();
+    writer.join();
+    // Whatever the writer's last swap missed; emit() adds nothing after stopping
+    std::vector<Event> rest;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        rest.swap(pending);
+    }
+    writeEvents(rest);
+    fputs("\n]\n", out);
+    fclose(out);
+    out = nullptr;
+}
+
+} // namespace Trace
+
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+
+// Opt-in Chrome/Perfetto trace-event export. Build with `make TRACE=1` to
+// compile the instrumentation in, then set CYBERGRIND_TRACE=<file.json> to
+// record. Without TRACE=1 every TRACE_* macro expands to nothing.
+
+#ifdef CYBERGRIND_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Trace {
+
+extern std::atomic<bool> active;
+
+// Starts the background writer if CYBERGRIND_TRACE names an output file
+void init();
+// Writes out everything still buffered and closes the JSON array
+void shutdown();
+
+uint64_t nowMicros();
+void emit(const char* name, uint64_t start, uint64_t end);
+
+// Records a complete ("X") event covering its own lifetime
+class Scope {
+public:
+    explicit Scope(const char* n) : name(n), start(active.load(std::memory_order_relaxed) ? nowMicros() : 0) {}
+    ~Scope() {
+        if (start) emit(name, start, nowMicros());
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+} // namespace Trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_INIT() Trace::init()
+#define TRACE_SHUTDOWN() Trace::shutdown()
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_INIT() ((void)0)
+#define TRACE_SHUTDOWN() ((void)0)
+
+#endif
@@ -1,6 +1,8 @@
 #include "utils.hpp"
 #include "constants.hpp"
 #include <cstdio>
+#include <cmath>
+#include <charconv>
 #include <vector>
 #include <filesystem>
 #include <cstdlib>
@@ -9,28 +11,95 @@ namespace fs = std::filesystem;
 
 namespace Utils {
 
-std::string formatNumber(double num) {
-    if (num < 1000.0) {
-        char buffer[32];
-        snprintf(buffer, sizeof(buffer), "%.2f", num);
-        return std::string(buffer);
-    }
+namespace {
 
-    const char* suffixes[] = {"", "K", "M", "B", "T", "Qa", "Qi", "Sx", "Sp", "Oc", "No", "Dc"};
-    int suffixIndex = 0;
-    double displayNum = num;
+const char* const SUFFIXES[] = {"", "K", "M", "B", "T", "Qa", "Qi", "Sx", "Sp", "Oc", "No", "Dc"};
+const int LAST_SUFFIX = 11;
 
+// Strips suffixes off num; false once it is past the last one
+bool suffixed(BigNum num, double& displayNum, int& suffixIndex) {
+    displayNum = num.toDouble();
+    suffixIndex = 0;
     // repeated div until num < 1000 or ran out of indexes
-    while (displayNum >= 1000.0 && suffixIndex < 11) {
+    while (displayNum >= 1000.0 && suffixIndex < LAST_SUFFIX) {
         displayNum /= 1000.0;
         suffixIndex++;
     }
+    // Negatives never take a suffix, but ones past double's range still need
+    // an exponent
+    return !(displayNum >= 1000.0) && (std::isfinite(displayNum) || !num.isFinite());
+}
 
-    char buffer[32];
-    snprintf(buffer, sizeof(buffer), "%.2f%s", displayNum, suffixes[suffixIndex]);
+// Power of ten num is written against past the suffixes
+int64_t shownExponent(BigNum num, Utils::Notation notation) {
+    int64_t k = (int64_t)std::floor(num.log10());
+    if (notation == Utils::Notation::SCIENTIFIC) return k;
+    return k - ((k % 3) + 3) % 3;
+}
+
+}
+
+std::string formatNumber(BigNum num, Notation notation) {
+    char buffer[64];
+    formatNumber(num, buffer, sizeof(buffer), notation);
     return std::string(buffer);
 }
 
+// Allocation-free variant for per-frame use; writes a NUL-terminated string
+// into buf and returns its length
+int formatNumber(BigNum num, char* buf, size_t size, Notation notation) {
+    double displayNum;
+    int suffixIndex;
+    const char* suffix = "";
+    char exponent[24] = "";
+    if (suffixed(num, displayNum, suffixIndex)) {
+        suffix = SUFFIXES[suffixIndex];
+    } else if (num.isFinite()) {
+        int64_t shown = shownExponent(num, notation);
+        int64_t width = notation == Notation::SCIENTIFIC ? 1 : 3;
+        displayNum = (num / BigNum::pow(10.0, (double)shown)).toDouble();
+        // Rounding to two decimals can carry into the next power
+        if (std::round(displayNum * 100) >= std::pow(10.0, width) * 100) {
+            displayNum /= std::pow(10.0, width);
+            shown += width;
+        }
+        snprintf(exponent, sizeof(exponent), "e%lld", (long long)shown);
+        suffix = exponent;
+    }
+
+    char* end = buf + size - 1;
+    auto res = std::to_chars(buf, end, displayNum, std::chars_format::fixed, 2);
+    if (res.ec != std::errc()) {
+        // Too wide for the buffer even in fixed notation
+        res = std::to_chars(buf, end, displayNum, std::chars_format::scientific, 2);
+        if (res.ec != std::errc()) res.ptr = buf;
+    }
+    char* p = res.ptr;
+    for (const char* s = suffix; *s && p < end; s++) *p++ = *s;
+    *p = '\0';
+    return (int)(p - buf);
+}
+
+NumberBand numberBand(BigNum num, Notation notation) {
+    double displayNum;
+    int suffixIndex;
+    if (suffixed(num, displayNum, suffixIndex) || !num.isFinite()) {
+        double step = 0.01;
+        for (int i = 0; i < suffixIndex; i++) step *= 1000.0;
+        return {step, suffixIndex > 0 ? step * 100.0 : -INFINITY, step * 1e5};
+    }
+    int64_t shown = shownExponent(num, notation);
+    int64_t width = notation == Notation::SCIENTIFIC ? 1 : 3;
+    return {BigNum::pow(10.0, (double)(shown - 2)), BigNum::pow(10.0, (double)shown),
+            BigNum::pow(10.0, (double)(shown + width))};
+}
+
+// Smallest change to num that formatNumber can show, i.e. one unit in the
+// last printed digit at num's current suffix or power of ten.
+BigNum formatStep(BigNum num, Notation notation) {
+    return numberBand(num, notation).step;
+}
+
 std::string getDataPath(const std::string& filename) {
     // Check local data first
     fs::path localPath = fs::path("./data") / filename;
@@ -41,8 +110,8 @@ std::string getDataPath(const std::string& filename) {
     return globalPath.string();
 }
 
-std::string getSavePath() {
-    const char* xdgDataHome = std::getenv("XDG_DATA_HOME");
+std::string getSavePath(const std::string& dataHome) {
+    const char* xdgDataHome = dataHome.empty() ? std::getenv("XDG_DATA_HOME") : dataHome.c_str();
     fs::path saveDir;
     if (xdgDataHome) {
         saveDir = fs::path(xdgDataHome) / "cybergrind";
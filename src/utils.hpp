@@ -1,9 +1,29 @@
 #pragma once
 
 #include <string>
+#include <cstddef>
+#include "big_number.hpp"
 
 namespace Utils {
-    std::string formatNumber(double num);
+    // How numbers past the last suffix (1000 Dc) are written
+    enum class Notation {
+        ENGINEERING,    // 123.45e42
+        SCIENTIFIC      // 1.23e44
+    };
+
+    // Every value within half a step of a multiple of step, inside
+    // [floor, ceiling), formats to the same text
+    struct NumberBand {
+        BigNum step;
+        BigNum floor;
+        BigNum ceiling;
+    };
+
+    std::string formatNumber(BigNum num, Notation notation = Notation::ENGINEERING);
+    int formatNumber(BigNum num, char* buf, size_t size, Notation notation = Notation::ENGINEERING);
+    NumberBand numberBand(BigNum num, Notation notation = Notation::ENGINEERING);
+    BigNum formatStep(BigNum num, Notation notation = Notation::ENGINEERING);
     std::string getDataPath(const std::string& filename);
-    std::string getSavePath();
+    // dataHome stands in for $XDG_DATA_HOME when given
+    std::string getSavePath(const std::string& dataHome = "");
 }
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <ncurses.h>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "utils.hpp"
+
+// Remembers what each dynamic field of a window last showed, so the renderer
+// only repaints the cells whose text or attributes actually changed.
+class ViewModel {
+public:
+    explicit ViewModel(int slots = 0) : fields(slots) {}
+
+    // Forget everything; the next paint of every slot draws unconditionally
+    void reset(int slots) {
+        fields.assign(slots, Field{});
+    }
+
+    int size() const { return (int)fields.size(); }
+
+    const char* text(int slot) const { return fields[slot].text; }
+
+    // False while value still formats (through Utils::formatNumber) to the
+    // text the slot was last painted with, so callers can skip formatting.
+    // The cached range is shrunk slightly so rounding near an edge only ever
+    // costs a spurious format, never a missed change.
+    bool numberChanged(int slot, BigNum value, Utils::Notation notation = Utils::Notation::ENGINEERING) {
+        Field& f = fields[slot];
+        if (value >= f.lo && value < f.hi) return false;
+
+        // floor and ceiling are where the suffix or power of ten changes
+        Utils::NumberBand band = Utils::numberBand(value, notation);
+        double k = std::round((value / band.step).toDouble());
+        f.lo = std::max((k - 0.5) * band.step, band.floor) + band.step * 1e-6;
+        f.hi = std::min((k + 0.5) * band.step, band.ceiling) - band.step * 1e-6;
+        return true;
+    }
+
+    // Draw text at (y, x) unless the slot already shows exactly this. Leftover
+    // cells from a longer previous text are overwritten with fill. Output is
+    // clipped to width columns, or to just inside the border when width < 0.
+    bool paint(WINDOW* win, int slot, int y, int x, attr_t attrs, const char* text,
+               int width = -1, chtype fill = ' ') {
+        Field& f = fields[slot];
+        if (f.painted && f.attrs == attrs && std::strcmp(f.text, text) == 0) return false;
+
+        int maxWidth = getmaxx(win) - 1 - x;
+        if (width < 0 || width > maxWidth) width = maxWidth;
+        if (width <= 0) return false;
+
+        int len = std::min((int)std::strlen(text), width);
+        wattr_set(win, attrs, PAIR_NUMBER(attrs), nullptr);
+        mvwaddnstr(win, y, x, text, len);
+        wattr_set(win, A_NORMAL, 0, nullptr);
+        for (int i = len; i < std::min(f.len, width); i++) {
+            mvwaddch(win, y, x + i, fill);
+        }
+
+        if (text != f.text) {
+            std::strncpy(f.text, text, FIELD_CAPACITY - 1);
+            f.text[FIELD_CAPACITY - 1] = '\0';
+        }
+        f.len = len;
+        f.attrs = attrs;
+        f.painted = true;
+        return true;
+    }
+
+private:
+    static const int FIELD_CAPACITY = 256;
+
+    struct Field {
+        char text[FIELD_CAPACITY] = "";
+        int len = 0;
+        attr_t attrs = A_NORMAL;
+        bool painted = false;
+        BigNum lo = 1.0, hi = 0.0; // value range that formats to text; empty until first use
+    };
+
+    std::vector<Field> fields;
+};
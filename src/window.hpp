@@ -39,6 +39,12 @@ public:
         wrefresh(win);
     }
 
+    // Copy to the virtual screen only; the caller flushes with doupdate()
+    void stage() {
+        if (!win) return;
+        wnoutrefresh(win);
+    }
+
     WINDOW* get() const { return win; }
 
 private:
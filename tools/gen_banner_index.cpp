@@ -0,0 +1,75 @@
+// Records where each banner starts and ends in data/banners.txt, so the splash
+// screen can read the one it shows and skip the rest.
+// usage: gen_banner_index <banners.txt> <banner_index.hpp>
+
+#include "../src/banners.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <banners.txt> <banner_index.hpp>\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in.is_open()) {
+        fprintf(stderr, "gen_banner_index: cannot read %s\n", argv[1]);
+        return 1;
+    }
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (text.size() > UINT32_MAX) {
+        fprintf(stderr, "gen_banner_index: %s is too large\n", argv[1]);
+        return 1;
+    }
+
+    // Same splitting as the fallback scan: a line that is exactly "@@@" (after
+    // dropping a trailing \r) ends a banner, and empty banners are skipped
+    std::string rows;
+    size_t start = 0, pos = 0;
+    int count = 0;
+    auto emit = [&](size_t end) {
+        if (end == start) return;
+        char row[96];
+        snprintf(row, sizeof(row), "    {%zu, %zu, 0x%016llxULL},\n", start, end - start,
+                 (unsigned long long)bannerHash(text.data() + start, end - start));
+        rows += row;
+        count++;
+    };
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        size_t next = eol == std::string::npos ? text.size() : eol + 1;
+        std::string line = text.substr(pos, (eol == std::string::npos ? text.size() : eol) - pos);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line == "@@@") {
+            emit(pos);
+            start = next;
+        }
+        pos = next;
+    }
+    emit(text.size());
+
+    FILE* out = fopen(argv[2], "w");
+    if (!out) {
+        fprintf(stderr, "gen_banner_index: cannot write %s\n", argv[2]);
+        return 1;
+    }
+    fprintf(out, "// Generated from %s by tools/gen_banner_index. Do not edit.\n"
+                 "#pragma once\n\n"
+                 "#include \"banners.hpp\"\n\n"
+                 "// The index only applies to a file of exactly this size, and each\n"
+                 "// banner only if its bytes still have the recorded hash\n"
+                 "inline constexpr uint32_t BANNERS_FILE_SIZE = %zu;\n",
+            argv[1], text.size());
+    if (count > 0) {
+        fprintf(out, "inline constexpr BannerSpan BANNER_INDEX[] = {\n%s};\n", rows.c_str());
+    } else {
+        // A zero-length array isn't valid C++; an empty span keeps the code uniform
+        fprintf(out, "inline constexpr BannerSpan BANNER_INDEX[] = {{0, 0, 0}};\n");
+    }
+    fprintf(out, "inline constexpr int BANNER_COUNT = %d;\n", count);
+    return fclose(out) == 0 ? 0 : 1;
+}
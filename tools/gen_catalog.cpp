@@ -0,0 +1,81 @@
+// Turns data/buildings.json into a header holding the catalog as a constexpr
+// table, so the default game starts without reading or parsing anything.
+// usage: gen_catalog <buildings.json> <catalog_data.hpp>
+
+#include "../src/json.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Octal escapes are always three digits, so they can't swallow what follows
+std::string quote(const std::string& s) {
+    std::string out = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += (char)c;
+        } else if (c >= 0x20 && c < 0x7f) {
+            out += (char)c;
+        } else {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\%03o", c);
+            out += buf;
+        }
+    }
+    return out + "\"";
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <buildings.json> <catalog_data.hpp>\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream in(argv[1]);
+    if (!in.is_open()) {
+        fprintf(stderr, "gen_catalog: cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    std::string rows;
+    try {
+        json data = json::parse(in);
+        if (!data.is_array() || data.empty()) {
+            fprintf(stderr, "gen_catalog: %s: expected a non-empty array of buildings\n", argv[1]);
+            return 1;
+        }
+        int index = 0;
+        for (const auto& item : data) {
+            char row[512];
+            // %.17g round-trips every double exactly
+            snprintf(row, sizeof(row), "    {%d, %s, %.17g, %.17g},\n",
+                     item.value("id", index),
+                     quote(item.at("name").get<std::string>()).c_str(),
+                     item.at("basecost").get<double>(),
+                     item.at("baselps").get<double>());
+            rows += row;
+            index++;
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "gen_catalog: %s: %s\n", argv[1], e.what());
+        return 1;
+    }
+
+    FILE* out = fopen(argv[2], "w");
+    if (!out) {
+        fprintf(stderr, "gen_catalog: cannot write %s\n", argv[2]);
+        return 1;
+    }
+    fprintf(out, "// Generated from %s by tools/gen_catalog. Do not edit.\n"
+                 "#pragma once\n\n"
+                 "#include \"catalog.hpp\"\n\n"
+                 "inline constexpr CatalogEntry BUILTIN_CATALOG[] = {\n%s};\n",
+            argv[1], rows.c_str());
+    return fclose(out) == 0 ? 0 : 1;
+}